@@ -0,0 +1,430 @@
+// ****************************************************************************
+//     Filename: MoodBoardBench.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Audio engine benchmark
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include <JuceHeader.h>
+#include "SignalGraph.h"
+#include "Metering.h"
+#include "Looper.h"
+#include "AudioProfiler.h"
+
+// ****************************************************************************
+// Times every block the engine processes and reports percentiles as JSON, so
+//   runs on different machines or commits can be diffed:
+//
+//   MoodBoardBench [--case routing|mixing|metering|native|profiled] [--seconds 5]
+//                  [--out results.json]
+//
+// Real VST3s are replaced by stand-ins with a fixed, plugin-like cost so the
+//   numbers only move when our code does.
+
+// ****************************************************************************
+class StandInProcessor final : public juce::AudioPluginInstance
+{
+public:
+    enum class Kind { gain, filter, delay };
+
+    explicit StandInProcessor (Kind processorKind)
+        : AudioPluginInstance (BusesProperties().withInput  ("Input",  juce::AudioChannelSet::stereo())
+                                                .withOutput ("Output", juce::AudioChannelSet::stereo())),
+          kind (processorKind) {
+    }
+
+    void fillInPluginDescription (juce::PluginDescription& d) const override {
+
+        d.name = getName();
+        d.pluginFormatName = "Internal";
+        d.fileOrIdentifier = "internal:standin";
+        d.numInputChannels = 2;
+        d.numOutputChannels = 2;
+    }
+
+    const juce::String getName() const override {
+
+        switch (kind) {
+            case Kind::gain:    return "Stand-in Gain";
+            case Kind::filter:  return "Stand-in Filter";
+            case Kind::delay:   return "Stand-in Delay";
+        }
+        return {};
+    }
+
+    void prepareToPlay (double sampleRate, int) override {
+
+        // A gentle low pass, cascaded to cost roughly what an amp sim's EQ does
+        const auto w = juce::MathConstants<double>::twoPi * 5000.0 / sampleRate;
+        const auto alpha = std::sin (w) / (2.0 * 0.707);
+        const auto a0 = 1.0 + alpha;
+        b0 = (float) ((1.0 - std::cos (w)) * 0.5 / a0);
+        b1 = (float) ((1.0 - std::cos (w)) / a0);
+        b2 = b0;
+        a1 = (float) (-2.0 * std::cos (w) / a0);
+        a2 = (float) ((1.0 - alpha) / a0);
+        for (auto& channel : biquads)
+            for (auto& s : channel)
+                s = {};
+
+        delayLine.setSize (2, juce::roundToInt (sampleRate * 0.5));
+        delayLine.clear();
+        delayPosition = 0;
+    }
+
+    void releaseResources() override                    {}
+
+    void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override {
+
+        juce::ScopedNoDenormals noDenormals;
+        const int numChannels = juce::jmin (2, buffer.getNumChannels());
+        const int numSamples = buffer.getNumSamples();
+
+        switch (kind) {
+            case Kind::gain:
+                buffer.applyGain (0.5f);
+            break;
+
+            case Kind::filter:
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    auto* data = buffer.getWritePointer (ch);
+                    for (auto& s : biquads[(size_t) ch]) {
+                        for (int i = 0; i < numSamples; ++i) {
+                            const auto x = data[i];
+                            const auto y = b0 * x + s.z1;
+                            s.z1 = b1 * x - a1 * y + s.z2;
+                            s.z2 = b2 * x - a2 * y;
+                            data[i] = y;
+                        }
+                    }
+                }
+            break;
+
+            case Kind::delay: {
+                const int length = delayLine.getNumSamples();
+                int position = delayPosition;
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    auto* data = buffer.getWritePointer (ch);
+                    auto* line = delayLine.getWritePointer (ch);
+                    position = delayPosition;
+                    for (int i = 0; i < numSamples; ++i) {
+                        const auto delayed = line[position];
+                        line[position] = data[i] + delayed * 0.5f;
+                        data[i] += delayed;
+                        if (++position == length)
+                            position = 0;
+                    }
+                }
+                delayPosition = position;
+            }
+            break;
+        }
+    }
+
+    double getTailLengthSeconds() const override        { return kind == Kind::delay ? 5.0 : 0.0; }
+    bool acceptsMidi() const override                   { return false; }
+    bool producesMidi() const override                  { return false; }
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override                     { return false; }
+    int getNumPrograms() override                       { return 1; }
+    int getCurrentProgram() override                    { return 0; }
+    void setCurrentProgram (int) override               {}
+    const juce::String getProgramName (int) override    { return {}; }
+    void changeProgramName (int, const juce::String&) override {}
+    void getStateInformation (juce::MemoryBlock&) override {}
+    void setStateInformation (const void*, int) override {}
+
+private:
+
+    struct BiquadState
+    {
+        float z1 = 0.0f, z2 = 0.0f;
+    };
+
+    Kind kind;
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    std::array<std::array<BiquadState, 8>, 2> biquads {};
+
+    juce::AudioBuffer<float> delayLine;
+    int delayPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StandInProcessor)
+};
+
+// ****************************************************************************
+struct BenchResult
+{
+    juce::String name;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    std::vector<double> microseconds;       // one per timed block
+};
+
+// ****************************************************************************
+class EngineBench
+{
+public:
+
+    EngineBench (double rate, int block, double secondsToTime)
+        : sampleRate (rate),
+          blockSize (block),
+          numBlocks (juce::jmax (minBlocks, juce::roundToInt (secondsToTime * rate / block))),
+          input (1, block),
+          output (2, block) {
+
+        // A tone over a little noise, the same block every time
+        juce::Random random (1234);
+        for (int i = 0; i < blockSize; ++i)
+            input.setSample (0, i, 0.3f * std::sin ((float) i * 0.05f) + 0.01f * (random.nextFloat() - 0.5f));
+    }
+
+    // Default board with every slot empty, so only the copies, switching and
+    //  scheduling are left
+    BenchResult runRouting() {
+
+        SignalGraph graph;
+        installBoard (graph, BoardTopology::createDefaultBoard(), {});
+        return runGraph ("routing", graph, nullptr);
+    }
+
+    // Eight cheap parallel branches summed by one mixer
+    BenchResult runMixing() {
+
+        BoardTopology topology;
+        const auto in = topology.addNode (NodeKind::input, "Input");
+        const auto mixer = topology.addNode (NodeKind::mixer, "Mixer");
+        const auto out = topology.addNode (NodeKind::output, "Output");
+
+        std::vector<std::pair<int, std::unique_ptr<juce::AudioPluginInstance>>> plugins;
+        for (int i = 0; i < 8; ++i) {
+            const auto slot = topology.addNode (NodeKind::slot, "Branch " + juce::String (i + 1), i);
+            topology.connect (in, slot);
+            topology.connect (slot, mixer);
+            plugins.emplace_back (i, std::make_unique<StandInProcessor> (StandInProcessor::Kind::gain));
+        }
+        topology.connect (mixer, out);
+
+        SignalGraph graph;
+        installBoard (graph, std::move (topology), std::move (plugins));
+        return runGraph ("mixing", graph, nullptr);
+    }
+
+    // One stereo meter tap with true peak on, the most any tap costs
+    BenchResult runMetering() {
+
+        BenchResult result { "metering", sampleRate, blockSize, {} };
+        result.microseconds.reserve ((size_t) numBlocks);
+
+        MeterTap tap;
+        tap.setTruePeakEnabled (true);
+        const float* channels[] = { input.getReadPointer (0), input.getReadPointer (0) };
+
+        for (int i = 0; i < warmupBlocks + numBlocks; ++i) {
+            const auto start = juce::Time::getHighResolutionTicks();
+            tap.measure (channels, 2, blockSize);
+            if (i >= warmupBlocks)
+                result.microseconds.push_back (ticksToMicroseconds (juce::Time::getHighResolutionTicks() - start));
+        }
+        return result;
+    }
+
+    // The default board with our looper overdubbing and stand-ins for the
+    //  plugins people actually load there. Profiled runs the same board with
+    //  the audio profiler attached, to keep an eye on what it costs.
+    BenchResult runNative (bool profiled) {
+
+        auto looper = std::make_unique<LooperProcessor> (30.0, 0.0);
+        auto* looperPointer = looper.get();
+
+        std::vector<std::pair<int, std::unique_ptr<juce::AudioPluginInstance>>> plugins;
+        plugins.emplace_back (0, std::move (looper));
+        plugins.emplace_back (1, std::make_unique<StandInProcessor> (StandInProcessor::Kind::filter));
+        plugins.emplace_back (2, std::make_unique<StandInProcessor> (StandInProcessor::Kind::delay));
+        plugins.emplace_back (3, std::make_unique<StandInProcessor> (StandInProcessor::Kind::delay));
+        plugins.emplace_back (4, std::make_unique<StandInProcessor> (StandInProcessor::Kind::filter));
+
+        AudioProfiler profiler;
+        profiler.setSampleRate (sampleRate);
+
+        SignalGraph graph;
+        installBoard (graph, BoardTopology::createDefaultBoard(), std::move (plugins));
+        if (profiled)
+            graph.setProfiler (&profiler);
+
+        // Record during the warm up, then time the overdub
+        looperPointer->trigger (LooperProcessor::Command::record);
+        return runGraph (profiled ? "profiled" : "native", graph, [looperPointer] { looperPointer->trigger (LooperProcessor::Command::overdub); });
+    }
+
+private:
+
+    void installBoard (SignalGraph& graph, BoardTopology topology,
+                       std::vector<std::pair<int, std::unique_ptr<juce::AudioPluginInstance>>> plugins) {
+
+        // Filling an idle scene skips the crossfade a live swap would do
+        const auto scene = graph.addScene ("Bench", std::move (topology));
+        for (auto& [slot, plugin] : plugins)
+            graph.setScenePlugin (scene, slot, std::move (plugin));
+
+        // A slow machine would otherwise have the watchdog bypass the very
+        //  plugins being timed
+        graph.setWatchdogBudget (0.0);
+
+        // prepare() also prepares the plugins of every scene
+        graph.selectScene (scene);
+        graph.prepare (sampleRate, blockSize);
+    }
+
+    BenchResult runGraph (const juce::String& name, SignalGraph& graph, std::function<void()> afterWarmup) {
+
+        BenchResult result { name, sampleRate, blockSize, {} };
+        result.microseconds.reserve ((size_t) numBlocks);
+
+        const float* inputs[] = { input.getReadPointer (0) };
+        float* outputs[] = { output.getWritePointer (0), output.getWritePointer (1) };
+
+        for (int i = 0; i < warmupBlocks + numBlocks; ++i) {
+            if (i == warmupBlocks && afterWarmup != nullptr)
+                afterWarmup();
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            graph.process (inputs, 1, outputs, 2, blockSize);
+            if (i >= warmupBlocks)
+                result.microseconds.push_back (ticksToMicroseconds (juce::Time::getHighResolutionTicks() - start));
+        }
+        return result;
+    }
+
+    static double ticksToMicroseconds (juce::int64 ticks) {
+
+        return juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6;
+    }
+
+    static constexpr int warmupBlocks = 500;
+    static constexpr int minBlocks = 2000;
+
+    double sampleRate;
+    int blockSize;
+    int numBlocks;
+    juce::AudioBuffer<float> input, output;
+};
+
+// ****************************************************************************
+static juce::var toJson (BenchResult& result) {
+
+    auto& times = result.microseconds;
+    std::sort (times.begin(), times.end());
+
+    // Nearest rank
+    auto percentile = [&times] (double p) {
+        const auto rank = (size_t) std::ceil (p / 100.0 * (double) times.size());
+        return times[juce::jlimit ((size_t) 0, times.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+
+    const auto budget = result.blockSize / result.sampleRate * 1.0e6;
+    const auto mean = std::accumulate (times.begin(), times.end(), 0.0) / (double) times.size();
+
+    auto* entry = new juce::DynamicObject();
+    entry->setProperty ("case", result.name);
+    entry->setProperty ("sampleRate", result.sampleRate);
+    entry->setProperty ("blockSize", result.blockSize);
+    entry->setProperty ("blocks", (int) times.size());
+    entry->setProperty ("budgetUs", budget);
+    entry->setProperty ("meanUs", mean);
+    entry->setProperty ("p50Us", percentile (50.0));
+    entry->setProperty ("p99Us", percentile (99.0));
+    entry->setProperty ("p999Us", percentile (99.9));
+    entry->setProperty ("maxUs", times.back());
+    return entry;
+}
+
+// ****************************************************************************
+int main (int argc, char* argv[]) {
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+
+    auto argument = [&args] (const juce::String& name) {
+        const auto index = args.indexOf (name);
+        return index >= 0 && index + 1 < args.size() ? args[index + 1] : juce::String();
+    };
+
+    const auto onlyCase = argument ("--case");
+    const auto seconds = argument ("--seconds").isNotEmpty() ? argument ("--seconds").getDoubleValue() : 5.0;
+    const auto outputName = argument ("--out");
+
+    const juce::StringArray cases { "routing", "mixing", "metering", "native", "profiled" };
+    if (onlyCase.isNotEmpty() && ! cases.contains (onlyCase)) {
+        std::cerr << "Unknown case " << onlyCase << ", expected one of " << cases.joinIntoString (", ") << std::endl;
+        return 1;
+    }
+
+    juce::Array<juce::var> results;
+
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0 }) {
+        for (auto blockSize : { 32, 64, 128, 256, 512, 1024 }) {
+            EngineBench bench (sampleRate, blockSize, seconds);
+
+            for (auto& name : cases) {
+                if (onlyCase.isNotEmpty() && name != onlyCase)
+                    continue;
+
+                auto result = name == "routing"  ? bench.runRouting()
+                            : name == "mixing"   ? bench.runMixing()
+                            : name == "metering" ? bench.runMetering()
+                                                 : bench.runNative (name == "profiled");
+
+                auto json = toJson (result);
+                std::cerr << name << " " << sampleRate << " Hz / " << blockSize << ": p99 "
+                          << (double) json["p99Us"] << " us of " << (double) json["budgetUs"] << " us" << std::endl;
+                results.add (json);
+            }
+        }
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty ("version", 1);
+    report->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+    report->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty ("numCpus", juce::SystemStats::getNumCpus());
+    report->setProperty ("results", results);
+
+    const auto text = juce::JSON::toString (juce::var (report));
+    if (outputName.isEmpty()) {
+        std::cout << text << std::endl;
+        return 0;
+    }
+
+    if (! juce::File::getCurrentWorkingDirectory().getChildFile (outputName).replaceWithText (text)) {
+        std::cerr << "Unable to write " << outputName << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+// ****************************************************************************
+//     Filename: AudioProfiler.h
+// Date Created: 10/17/2026
+//
+//     Comments: Audio thread profiler module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Times the audio callback and every plugin it runs without ever blocking it.
+//   Each lane is a single producer / single consumer ring: lane 0 belongs to
+//   the thread calling SignalGraph::process() and lane n + 1 to task n of the
+//   compiled schedule, which only ever runs on one thread at a time. A
+//   background thread drains the lanes into per-node histograms covering the
+//   last few seconds and, while a trace is being recorded, into a Chrome
+//   trace file (load it in chrome://tracing or ui.perfetto.dev).
+
+struct ProfileEvent
+{
+    juce::int64 start = 0;          // high resolution ticks
+    juce::int64 end = 0;
+    int node = -1;                  // topology node, or blockNode
+    int numSamples = 0;
+};
+
+class AudioProfiler final : private juce::Thread
+{
+public:
+
+    static constexpr int blockNode = -1;
+    static constexpr int blockLane = 0;
+    static constexpr int maxLanes = 64;
+    static constexpr int maxNodes = 64;
+
+    AudioProfiler();
+    ~AudioProfiler() override;
+
+    // Real-time safe. Events are dropped if the lane is full.
+    static juce::int64 now()                            { return juce::Time::getHighResolutionTicks(); }
+    void record (int lane, int node, juce::int64 start, juce::int64 end, int numSamples);
+
+    // Message thread
+    void setSampleRate (double newSampleRate)           { sampleRate.store (newSampleRate); }
+    void setNodeNames (const juce::StringArray& names);
+
+    struct Summary
+    {
+        double load = 0.0;          // callback time over real time, last half second
+        double peakLoad = 0.0;      // worst single block in the same window
+        int worstNode = -1;         // highest p99 over the last few seconds
+        juce::String worstNodeName;
+        double worstNodeP99Us = 0.0;
+        int droppedEvents = 0;
+    };
+
+    Summary getSummary() const;
+
+    bool startTrace (const juce::File& file);
+    void stopTrace();
+    bool isTracing() const;
+
+private:
+
+    struct Lane
+    {
+        juce::AbstractFifo fifo { laneCapacity };
+        std::vector<ProfileEvent> events = std::vector<ProfileEvent> ((size_t) laneCapacity);
+    };
+
+    // Log spaced, eight buckets per octave from a quarter of a microsecond
+    static constexpr int bucketsPerOctave = 8;
+    static constexpr int numBuckets = 20 * bucketsPerOctave;
+    static constexpr double minBucketUs = 0.25;
+    using Histogram = std::array<juce::uint32, (size_t) numBuckets>;
+
+    static int bucketFor (double microseconds);
+    static double bucketUpperUs (int bucket);
+
+    void run() override;
+    void drainLane (int lane);
+    void handleEvent (int lane, const ProfileEvent& event);
+    void rollWindows();
+    void writeTraceEvent (int lane, const ProfileEvent& event);
+
+    static constexpr int laneCapacity = 4096;
+    static constexpr int drainIntervalMs = 20;
+    static constexpr int loadWindowMs = 500;
+    static constexpr int historySeconds = 5;
+
+    juce::OwnedArray<Lane> lanes;
+    std::atomic<int> droppedEvents { 0 };
+    std::atomic<double> sampleRate { 48000.0 };
+    const double ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+
+    // Drain thread only
+    std::vector<std::vector<Histogram>> history;    // [second][node]
+    int currentWindow = 0;
+    juce::uint32 windowStartMs = 0;
+    juce::uint32 loadStartMs = 0;
+    double busySeconds = 0.0, realSeconds = 0.0, peakLoad = 0.0;
+
+    mutable juce::CriticalSection lock;             // the fields below
+    juce::StringArray nodeNames;
+    Summary summary;
+    std::unique_ptr<juce::FileOutputStream> trace;
+    juce::int64 traceStartTicks = 0;
+    bool firstTraceEvent = true;
+    std::array<bool, (size_t) maxLanes> laneNamed {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProfiler)
+};
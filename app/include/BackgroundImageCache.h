@@ -0,0 +1,75 @@
+// ****************************************************************************
+//     Filename: BackgroundImageCache.h
+// Date Created: 10/17/2026
+//
+//     Comments: Scaled background image cache module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Keeps an embedded image decoded and pre-scaled to the size it is shown at,
+//   so painting the window background is a 1:1 blit instead of a full
+//   rescale. Decoding and scaling happen on a background thread; until the
+//   image for the current size is ready the last one is stretched, or nothing
+//   is drawn at all before the first decode. Only the latest requested size
+//   is ever rendered, so dragging the window edge doesn't queue up work.
+
+class BackgroundImageCache final : private juce::Thread
+{
+public:
+
+    // onImageReady is called on the message thread whenever a new size is ready
+    BackgroundImageCache (const void* imageData, int imageDataSize, std::function<void()> onImageReady);
+    ~BackgroundImageCache() override;
+
+    // Message thread. Fills area the way RectanglePlacement::fillDestination
+    //  would. Returns false if there's nothing to draw yet.
+    bool draw (juce::Graphics& g, juce::Rectangle<int> area);
+
+private:
+
+    void run() override;
+    juce::Image renderScaled (const juce::Image& source, int width, int height) const;
+
+    const void* data;
+    const int dataSize;
+    std::function<void()> onReady;
+
+    juce::Image decoded;                    // background thread only
+    int renderedWidth = 0, renderedHeight = 0;
+    juce::Image shown;                      // message thread only
+
+    juce::CriticalSection lock;             // the fields below
+    juce::Image rendered;                   // waiting to be picked up by draw()
+    int requestedWidth = 0, requestedHeight = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundImageCache)
+};
@@ -0,0 +1,182 @@
+// ****************************************************************************
+//     Filename: BoardFile.h
+// Date Created: 10/17/2026
+//
+//     Comments: Binary board file module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "SignalGraph.h"
+
+class BoardFileReader;
+
+// ****************************************************************************
+// A plugin as a scene stores it: what to load, which slot it goes in and its
+//   saved state. The state may still be sitting unread in a board file.
+
+struct SlotRecipe
+{
+    int slot = -1;
+    juce::PluginDescription description;
+    bool outOfProcess = false;
+
+    juce::MemoryBlock state;
+    std::shared_ptr<BoardFileReader> source;    // state is read from here if set
+    int stateChunk = -1;
+
+    bool getState (juce::MemoryBlock& dest) const;
+
+    // Copies a state still in a board file into memory and lets go of the file
+    void loadState();
+};
+
+struct SceneRecipe
+{
+    juce::String name;
+    BoardTopology topology;
+    std::vector<SlotRecipe> plugins;
+};
+
+// ****************************************************************************
+// On-disk board layout, all integers little endian:
+//
+//   header   64 bytes: magic, version, index offset and size
+//   chunks   raw blobs (plugin states, descriptions and topologies as XML)
+//   index    chunk table (offset, size, content hash), then the scenes, each
+//            with its name, topology chunk and one entry per plugin slot
+//
+// Chunks are addressed by content, so a save only appends the blobs that
+//   changed, writes a fresh index after them and then points the header at
+//   it. The file is compacted once more than half of it is dead.
+
+struct BoardChunk
+{
+    juce::int64 offset = 0;
+    juce::int64 size = 0;
+    juce::uint64 hash = 0;
+};
+
+// ****************************************************************************
+// Memory maps a board file and parses only the header and index. Plugin
+//   states are copied out of the mapping on demand, so opening a board only
+//   pages in the chunks of the scenes that actually get loaded.
+
+class BoardFileReader final : public std::enable_shared_from_this<BoardFileReader>
+{
+public:
+
+    static std::shared_ptr<BoardFileReader> open (const juce::File& file, juce::String& error);
+    ~BoardFileReader();
+
+    // Whether any reader still has the file mapped. Windows won't let a file
+    //  be written or replaced while it is, so savers check this first.
+    static bool isMapped (const juce::File& file);
+
+    const juce::File& getFile() const                   { return file; }
+    int getCurrentScene() const                         { return currentScene; }
+
+    // Descriptions and topologies are read now, states stay in the file
+    std::vector<SceneRecipe> createScenes();
+
+    int getNumChunks() const                            { return (int) chunks.size(); }
+    const BoardChunk& getChunk (int index) const        { return chunks[(size_t) index]; }
+    bool readChunk (int index, juce::MemoryBlock& dest) const;
+
+private:
+
+    struct PluginEntry
+    {
+        int slot;
+        int descriptionChunk;
+        int stateChunk;
+        bool outOfProcess;
+    };
+
+    struct SceneEntry
+    {
+        juce::String name;
+        int topologyChunk;
+        std::vector<PluginEntry> plugins;
+    };
+
+    explicit BoardFileReader (const juce::File& boardFile) : file (boardFile) {}
+    bool parse (juce::String& error);
+    std::unique_ptr<juce::XmlElement> readXmlChunk (int index) const;
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> map;
+    std::vector<BoardChunk> chunks;
+    std::vector<SceneEntry> scenes;
+    int currentScene = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BoardFileReader)
+};
+
+// ****************************************************************************
+// Writes boards on a background thread. Callers hand over a snapshot and
+//   carry on; if saves arrive faster than the disk, only the newest pending
+//   one is written.
+
+class BoardFileWriter final : private juce::Thread
+{
+public:
+
+    BoardFileWriter();
+    ~BoardFileWriter() override;
+
+    void save (const juce::File& file, std::vector<SceneRecipe> scenes, int currentScene);
+    bool isSaving() const                               { return busy.load(); }
+
+private:
+
+    struct Job
+    {
+        juce::File file;
+        std::vector<SceneRecipe> scenes;
+        int currentScene = 0;
+    };
+
+    void run() override;
+    bool write (const Job& job, juce::String& error);
+    void forgetKnownFile();
+
+    static constexpr juce::int64 compactThreshold = 1024 * 1024;
+
+    juce::CriticalSection jobLock;
+    std::unique_ptr<Job> pendingJob;
+    std::atomic<bool> busy { false };
+
+    // Chunk layout of the file we last wrote, writer thread only
+    juce::File knownFile;
+    std::map<std::pair<juce::uint64, juce::int64>, BoardChunk> knownChunks;
+    juce::int64 knownFileSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BoardFileWriter)
+};
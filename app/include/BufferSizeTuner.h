@@ -0,0 +1,132 @@
+// ****************************************************************************
+//     Filename: BufferSizeTuner.h
+// Date Created: 10/17/2026
+//
+//     Comments: Finds the smallest stable device buffer size
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioProfiler.h"
+
+// ****************************************************************************
+// Steps the audio device down through its buffer sizes, soaking each one with
+//   the current board running and measuring callback jitter, DSP load and
+//   xruns. The smallest size that holds up is kept and remembered per board
+//   and device, so opening that board on that interface again goes straight
+//   to it. If the size we start from already fails, sizes above it are tried
+//   instead.
+//
+// A size holds up when there are no xruns and the worst callback lateness plus
+//   the worst block's processing time still leave some of the period free.
+
+class BufferSizeTuner final : private juce::Timer
+{
+public:
+
+    struct Trial
+    {
+        int bufferSize = 0;
+        double peakLoad = 0.0;      // worst block, as a fraction of the period
+        double jitter = 0.0;        // worst callback lateness, same units
+        int xruns = 0;
+        bool stable = false;
+    };
+
+    using FinishedCallback = std::function<void (int bufferSize, const juce::Array<Trial>& trials)>;
+
+    BufferSizeTuner (juce::AudioDeviceManager& deviceManager, AudioProfiler& profiler, const juce::File& settingsFile);
+    ~BufferSizeTuner() override;
+
+    static juce::File getDefaultSettingsFile();
+
+    // Audio thread, at the top of every device callback
+    void callbackStarted (int numSamples) noexcept;
+
+    // From audioDeviceAboutToStart, before the first callback
+    void deviceStarted (double sampleRate) noexcept;
+
+    // Message thread. onFinished isn't called if the run is cancelled, in
+    //  which case the device goes back to the size it had.
+    bool start (const juce::String& boardKey, FinishedCallback onFinished);
+    void cancel();
+    bool isTuning() const                               { return isTimerRunning(); }
+    juce::String getStatus() const;
+
+    // Switches to the size found for this board on the current device, if any
+    bool applySaved (const juce::String& boardKey);
+
+    double settleSeconds = 1.0;     // ignored after every size change
+    double soakSeconds = 8.0;
+    double headroom = 0.85;         // jitter + peak load must stay below this
+
+private:
+
+    void timerCallback() override;
+    void beginTrial();
+    void finishTrial();
+    void evaluate (const Trial& trial);
+    void finish (int bufferSize);
+    bool setBufferSize (int bufferSize);
+
+    juce::String getDeviceKey() const;
+    int loadSaved (const juce::String& boardKey) const;
+    void save (const juce::String& boardKey, int bufferSize) const;
+
+    static constexpr int tickMs = 250;
+
+    juce::AudioDeviceManager& manager;
+    AudioProfiler& audioProfiler;
+    const juce::File file;
+
+    // Written by the audio thread
+    std::atomic<juce::int64> lastCallbackTicks { 0 };
+    std::atomic<int> lastNumSamples { 0 };
+    std::atomic<juce::int64> worstLatenessTicks { 0 };
+    std::atomic<int> lateCallbacks { 0 };
+    std::atomic<double> ticksPerSample { 0.0 };
+
+    // Message thread only
+    juce::String board;
+    FinishedCallback finished;
+    juce::Array<int> sizes;                 // ascending
+    int originalSize = 0;
+    int startIndex = 0;                     // index into sizes
+    int current = 0;
+    int direction = -1;
+    int bestStable = -1;                    // index into sizes
+    juce::Array<Trial> trials;
+    double trialStart = 0.0;
+    bool soaking = false;
+    double worstLoad = 0.0;
+    int startXRuns = 0;
+    int startLate = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferSizeTuner)
+};
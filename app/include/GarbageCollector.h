@@ -0,0 +1,82 @@
+// ****************************************************************************
+//     Filename: GarbageCollector.h
+// Date Created: 10/17/2026
+//
+//     Comments: Frees objects retired by the audio thread
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Takes ownership of objects the audio thread has finished with and deletes
+//   them on a background thread, so a callback never pays for a free. The
+//   audio thread only writes to a preallocated queue; the collector polls it
+//   rather than being woken, since signalling a thread can take a lock.
+//
+// One thread retires, one thread collects. Objects must be safe to delete off
+//   the message thread, which rules out plugin instances.
+
+class GarbageCollector final : private juce::Thread
+{
+public:
+
+    GarbageCollector();
+    ~GarbageCollector() override;
+
+    // Audio thread. A full queue refuses the object and the caller keeps it.
+    bool canRetire() const                              { return fifo.getFreeSpace() > 0; }
+
+    template <typename Object>
+    bool retire (Object* object)
+    {
+        return object == nullptr || push ({ object, [] (void* o) { delete static_cast<Object*> (o); } });
+    }
+
+private:
+
+    struct Item
+    {
+        void* object;
+        void (*destroy) (void*);
+    };
+
+    void run() override;
+    bool push (const Item& item);
+    void collect();
+
+    static constexpr int queueSize = 256;
+    static constexpr int pollIntervalMs = 20;
+
+    juce::AbstractFifo fifo { queueSize };
+    std::array<Item, queueSize> queue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GarbageCollector)
+};
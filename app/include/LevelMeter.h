@@ -36,109 +36,152 @@
 #include <JuceHeader.h>
 
 //==============================================================================
-class VerticalMeter  : public juce::Component {
+// Both meters work the same way: setLevel() only records the new value, and
+//  the display catches up on the next vertical blank. The gradient is rendered
+//  once per size into an image, so a redraw is a blit of the strip between the
+//  old and the new bar end. Frames where the bar doesn't move by a whole pixel
+//  cost nothing at all.
+class LevelMeterBase  : public juce::Component {
 public:
-    VerticalMeter() {
-
-        currentLevel = -60.0f;
-    }
-
-    ~VerticalMeter() override {
-    }
 
     void setLevel(float newLevel) {
         targetLevel = newLevel;
-        if (targetLevel > currentLevel)
-            currentLevel = targetLevel;
-        else if ((currentLevel - targetLevel) > 1.5f)
-            currentLevel -= 1.5f;
-        else
-            currentLevel = targetLevel;
-        repaint();
     }
 
     void paint (juce::Graphics& g) override {
 
-        auto bounds = getLocalBounds().toFloat();
+        // Only the invalidated strip is actually drawn, JUCE clips the rest
         g.setColour(Colour(0xff323232));
-        g.fillRect(bounds);
-        g.setGradientFill(gradient);
-        const auto scaledY = jmap(currentLevel, -60.0f, 6.0f, 0.0f, static_cast<float>(getHeight()));
-        g.fillRect(bounds.removeFromBottom(scaledY));
+        g.fillRect(getLocalBounds());
+
+        const auto filled = getFilledArea(shownExtent);
+        if (filled.isEmpty() || ! gradientImage.isValid())
+            return;
+
+        const auto scale = (float) gradientImage.getWidth() / (float) jmax(1, getWidth());
+        g.drawImage(gradientImage, filled.getX(), filled.getY(), filled.getWidth(), filled.getHeight(),
+                    roundToInt(filled.getX() * scale), roundToInt(filled.getY() * scale),
+                    roundToInt(filled.getWidth() * scale), roundToInt(filled.getHeight() * scale));
     }
 
     void resized() override {
 
-        auto bounds = getLocalBounds().toFloat();
-        gradient = ColourGradient {
-            Colours::deepskyblue,
-            bounds.getBottomLeft(),
-            Colours::red,
-            bounds.getTopLeft(),
-            false
-        };
-        gradient.addColour(0.75, Colours::skyblue);
+        renderGradient();
+        shownExtent = extentFor(currentLevel);
+        repaint();
     }
 
-private:
+protected:
 
-    ColourGradient gradient;
-    float currentLevel;
-    float targetLevel;
+    LevelMeterBase(bool isVertical, float minimumDb, float maximumDb, float decayDbPerSecond)
+        : vertical(isVertical),
+          minDb(minimumDb),
+          maxDb(maximumDb),
+          decayRate(decayDbPerSecond),
+          currentLevel(minimumDb),
+          targetLevel(minimumDb) {
 
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VerticalMeter)
-};
+        // Every pixel is ours, so nothing behind needs repainting with us
+        setOpaque(true);
+    }
 
-//==============================================================================
-class HorizontalMeter  : public juce::Component {
-public:
-    HorizontalMeter() {
+private:
 
-        currentLevel = -30.0f;
-    }
+    void onVBlank(double timestampSec) {
 
-    ~HorizontalMeter() override {
-    }
+        const auto elapsed = lastVBlank > 0.0 ? timestampSec - lastVBlank : 0.0;
+        lastVBlank = timestampSec;
 
-    void setLevel(float newLevel) {
-        targetLevel = newLevel;
-        if (targetLevel > currentLevel)
+        // Rise instantly, fall at the decay rate
+        if (targetLevel >= currentLevel)
             currentLevel = targetLevel;
-        else if ((currentLevel - targetLevel) > 0.5f)
-            currentLevel -= 0.5f;
         else
-            currentLevel = targetLevel;
-        repaint();
+            currentLevel = jmax(targetLevel, currentLevel - (float) (decayRate * elapsed));
+
+        const auto extent = extentFor(currentLevel);
+        if (extent == shownExtent)
+            return;
+
+        const auto low = jmin(extent, shownExtent);
+        const auto high = jmax(extent, shownExtent);
+        shownExtent = extent;
+
+        if (vertical)
+            repaint(0, getHeight() - high, getWidth(), high - low);
+        else
+            repaint(low, 0, high - low, getHeight());
     }
 
-    void paint (juce::Graphics& g) override {
+    int extentFor(float level) const {
 
-        auto bounds = getLocalBounds().toFloat();
-        g.setColour(Colour(0xff323232));
-        g.fillRect(bounds);
-        g.setGradientFill(gradient);
-        const auto scaledX = jmap(currentLevel, -30.0f, 0.0f, 0.0f, static_cast<float>(getWidth()));
-        g.fillRect(bounds.removeFromLeft(scaledX));
+        const auto length = vertical ? getHeight() : getWidth();
+        return jlimit(0, length, roundToInt(jmap(level, minDb, maxDb, 0.0f, (float) length)));
     }
 
-    void resized() override {
+    juce::Rectangle<int> getFilledArea(int extent) const {
+
+        return vertical ? juce::Rectangle<int>(0, getHeight() - extent, getWidth(), extent)
+                        : juce::Rectangle<int>(0, 0, extent, getHeight());
+    }
+
+    void renderGradient() {
+
+        const auto scale = juce::Component::getApproximateScaleFactorForComponent(this);
+        const auto width = roundToInt(getWidth() * scale);
+        const auto height = roundToInt(getHeight() * scale);
+        if (width <= 0 || height <= 0) {
+            gradientImage = {};
+            return;
+        }
 
         auto bounds = getLocalBounds().toFloat();
-        gradient = ColourGradient {
+        ColourGradient gradient {
             Colours::deepskyblue,
             bounds.getBottomLeft(),
             Colours::red,
-            bounds.getBottomRight(),
+            vertical ? bounds.getTopLeft() : bounds.getBottomRight(),
             false
         };
         gradient.addColour(0.75, Colours::skyblue);
+
+        gradientImage = juce::Image(juce::Image::RGB, width, height, false);
+        juce::Graphics g(gradientImage);
+        g.addTransform(juce::AffineTransform::scale(scale));
+        g.setGradientFill(gradient);
+        g.fillRect(bounds);
     }
 
-private:
+    const bool vertical;
+    const float minDb, maxDb;
+    const double decayRate;
 
-    ColourGradient gradient;
     float currentLevel;
     float targetLevel;
+    int shownExtent = 0;
+    double lastVBlank = 0.0;
+    juce::Image gradientImage;
+
+    juce::VBlankAttachment vblank { this, [this] (double timestampSec) { onVBlank(timestampSec); } };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterBase)
+};
 
+//==============================================================================
+class VerticalMeter  : public LevelMeterBase {
+public:
+    // -60 to +6 dB, falling 1.5 dB per 30 ms
+    VerticalMeter() : LevelMeterBase(true, -60.0f, 6.0f, 50.0f) {}
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VerticalMeter)
+};
+
+//==============================================================================
+class HorizontalMeter  : public LevelMeterBase {
+public:
+    // -30 to 0 dB, falling 0.5 dB per 30 ms
+    HorizontalMeter() : LevelMeterBase(false, -30.0f, 0.0f, 50.0f / 3.0f) {}
+
+private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HorizontalMeter)
-};
\ No newline at end of file
+};
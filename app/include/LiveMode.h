@@ -0,0 +1,96 @@
+// ****************************************************************************
+//     Filename: LiveMode.h
+// Date Created: 10/17/2026
+//
+//     Comments: Real-time setup for dedicated Linux machines
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class RealtimeThreadPool;
+
+// ****************************************************************************
+// Everything a dedicated Linux box can do to keep the audio thread on time:
+//   locked memory, SCHED_FIFO for the audio thread and the graph workers,
+//   each pinned to one of the cores isolated from the scheduler (isolcpus=),
+//   and prefaulted stacks. None of it is guaranteed, since it all depends on
+//   limits and kernel options, so the report says what we actually got.
+//
+// Memory is locked as pages fault in rather than up front, so the loop spill
+//   file isn't pulled into RAM. The graph's buffer pools and the looper's RAM
+//   pages are written when they're allocated, which faults and locks them
+//   before the audio thread ever sees them.
+
+class LiveMode
+{
+public:
+
+    static constexpr int audioPriority = 80;
+    static constexpr int workerPriority = 79;
+
+    // Locks memory straight away, so construct it before the engine allocates
+    explicit LiveMode (bool shouldEnable);
+
+    bool isEnabled() const                              { return enabled; }
+
+    // The audio thread gets the first isolated core, the workers the rest
+    static juce::Array<int> getIsolatedCores();
+    int getAudioCore() const                            { return cores.isEmpty() ? -1 : cores[0]; }
+    juce::Array<int> getWorkerCores() const;
+
+    // Message thread, before the device starts. The next callback sets up
+    //  the thread it runs on.
+    void deviceStarting()                               { audioSetupPending.store (enabled); }
+
+    // Audio thread. Only the first call after deviceStarting() does anything,
+    //  and that one makes system calls, so expect it to run long.
+    void setUpAudioThread();
+
+    // Message thread. Hands over the report once per device start, after the
+    //  audio thread has set itself up.
+    bool takeReport (juce::String& report, const RealtimeThreadPool* workers);
+    juce::String getReport (const RealtimeThreadPool* workers) const;
+
+private:
+
+    const bool enabled;
+    juce::Array<int> cores;
+    bool memoryLocked = false;
+    juce::String memoryError;
+
+    std::atomic<bool> audioSetupPending { false };
+    std::atomic<bool> reportReady { false };
+    std::atomic<bool> audioFifo { false };
+    std::atomic<bool> audioPinned { false };
+    std::atomic<bool> audioDenormalsOff { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LiveMode)
+};
@@ -0,0 +1,92 @@
+// ****************************************************************************
+//     Filename: LoopArena.h
+// Date Created: 10/17/2026
+//
+//     Comments: Preallocated loop storage module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Fixed-size pages of sample memory for the looper, all allocated up front.
+//   The first tier is ordinary RAM, touched at construction so the audio
+//   thread never takes a page fault on it. Once that runs out, pages come
+//   from a file-backed mapping, which the OS can write back and drop from RAM
+//   instead of swapping, so a ten minute pad costs disk rather than memory.
+//
+//   allocate() and release() are O(1) and must only be called from one
+//   thread (the audio thread). Spill pages only reach it once a background
+//   thread has zeroed them in prepareSpillPages(), so the first write to a
+//   sparse page (and the block allocation behind it) never lands in the
+//   callback. Released spill pages go back to that thread to be zeroed again.
+
+class LoopArena
+{
+public:
+
+    static constexpr int pageSize = 16384;      // samples per page
+
+    LoopArena (int numRamPages, int numSpillPages);
+    ~LoopArena();
+
+    int allocate();                             // -1 when no page is ready
+    void release (int page);
+
+    void prepareSpillPages();                   // background thread only
+
+    float* getPage (int page) const;
+    bool isSpilled (int page) const             { return page >= numRamPages; }
+
+    int getNumPages() const                     { return numRamPages + numSpillPages; }
+
+private:
+    static constexpr int numReadyPages = 8;     // zeroed spill pages kept ahead of the recorder
+
+    static bool push (juce::AbstractFifo& fifo, std::vector<int>& queue, int page);
+    static int pop (juce::AbstractFifo& fifo, std::vector<int>& queue);
+
+    const int numRamPages;
+    int numSpillPages;
+
+    juce::HeapBlock<float> ram;
+    juce::File spillFile;
+    std::unique_ptr<juce::MemoryMappedFile> spill;
+
+    std::vector<int> freeRam;
+
+    // Spill pages move between the audio thread and the preparing thread
+    juce::AbstractFifo readyFifo { numReadyPages + 1 };
+    std::vector<int> ready;
+    juce::AbstractFifo releasedFifo;
+    std::vector<int> released;
+    std::vector<int> unprepared;                // preparing thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoopArena)
+};
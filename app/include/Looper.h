@@ -0,0 +1,141 @@
+// ****************************************************************************
+//     Filename: Looper.h
+// Date Created: 10/17/2026
+//
+//     Comments: Built-in looper module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "LoopArena.h"
+
+// ****************************************************************************
+// The looper at the head of Path A. It records a loop, stacks overdubs on it
+//   as separate layers for undo and redo, and can multiply the loop out to a
+//   whole number of its original cycles. Each layer plays back modulo its own
+//   length, so the work per block depends on the number of layers and never
+//   on how long the loop is. All storage comes from a LoopArena sized at
+//   construction; nothing is allocated while audio runs.
+
+class LooperProcessor final : public juce::AudioPluginInstance
+{
+public:
+
+    enum class Command { none, record, overdub, multiply, undo, redo, togglePlay, clear };
+    enum class State { empty, recording, playing, overdubbing, multiplying, stopped };
+
+    // At 48 kHz the defaults hold two minutes of loop in RAM and ten more
+    //  in the spill file
+    explicit LooperProcessor (double ramSeconds = 120.0, double spillSeconds = 600.0);
+    ~LooperProcessor() override;
+
+    static juce::PluginDescription getDescription();
+    static constexpr const char* identifier = "internal:looper";
+
+    // Any thread. Takes effect at the start of the next block.
+    void trigger (Command command)                      { pendingCommand.store ((int) command); }
+    State getState() const                              { return (State) publishedState.load(); }
+    int getNumLayers() const                            { return publishedLayers.load(); }
+
+    void fillInPluginDescription (juce::PluginDescription& d) const override   { d = getDescription(); }
+    const juce::String getName() const override                                 { return getDescription().name; }
+
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override                    {}
+    void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override;
+
+    // A loop plays until it is stopped
+    double getTailLengthSeconds() const override        { return std::numeric_limits<double>::infinity(); }
+    bool acceptsMidi() const override                   { return false; }
+    bool producesMidi() const override                  { return false; }
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override                     { return false; }
+    int getNumPrograms() override                       { return 1; }
+    int getCurrentProgram() override                    { return 0; }
+    void setCurrentProgram (int) override               {}
+    const juce::String getProgramName (int) override    { return {}; }
+    void changeProgramName (int, const juce::String&) override {}
+
+    // Loops are performance material and aren't saved with the board
+    void getStateInformation (juce::MemoryBlock&) override {}
+    void setStateInformation (const void*, int) override {}
+
+private:
+
+    static constexpr int maxLayers = 16;
+    static constexpr int numChannels = 2;
+    static constexpr int minLoopLength = 2048;
+
+    struct Layer
+    {
+        juce::int64 length = 0;
+        std::array<std::vector<int>, numChannels> pages;    // arena page per page slot, -1 if never written
+        std::vector<int> used;                              // slot * numChannels + channel of every page held
+    };
+
+    void handleCommand (Command command);
+    bool startLayer();
+    void releaseLayer (Layer& layer);
+    void discardRedo();
+    void clearAll();
+    void finishRecording();
+    void endOverdub();
+    void selectTopLayer();
+
+    float* pageFor (Layer& layer, int channel, int slot);
+    void record (const juce::AudioBuffer<float>& input, int numSamples);
+    void overdub (const juce::AudioBuffer<float>& input, int numSamples);
+    void play (int numSamples);
+    void publishLookahead();
+
+    class SpillPrefetcher;
+
+    LoopArena arena;
+    int maxPagesPerLayer = 0;
+
+    // Audio thread only
+    std::array<Layer, maxLayers> layers;
+    int numLayers = 0;
+    int numRedoLayers = 0;
+    State state = State::empty;
+    juce::int64 playhead = 0;
+    juce::int64 loopLength = 0;
+    juce::int64 cycleLength = 0;
+    juce::AudioBuffer<float> mixBuffer;
+
+    std::atomic<int> pendingCommand { (int) Command::none };
+    std::atomic<int> publishedState { (int) State::empty };
+    std::atomic<int> publishedLayers { 0 };
+
+    // The spilled page each layer will play next, for the prefetcher
+    std::array<std::atomic<float*>, maxLayers * numChannels> lookahead {};
+    std::unique_ptr<SpillPrefetcher> prefetcher;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LooperProcessor)
+};
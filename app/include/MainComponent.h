@@ -41,6 +41,17 @@
 #include "Settings.h"
 #include "LevelMeter.h"
 #include "PluginWindow.h"
+#include "SignalGraph.h"
+#include "PluginScanCache.h"
+#include "PluginSandbox.h"
+#include "PluginLoader.h"
+#include "SceneCache.h"
+#include "Looper.h"
+#include "AudioProfiler.h"
+#include "BackgroundImageCache.h"
+#include "BufferSizeTuner.h"
+#include "MidiController.h"
+#include "LiveMode.h"
 
 // ****************************************************************************
 // This component lives inside our window, and this is where you should put all
@@ -53,7 +64,8 @@ class MainComponent final : public juce::Component,
 {
 public:
 
-    MainComponent();
+    // Live mode sets the process up for real-time work, see LiveMode
+    explicit MainComponent (bool live = false);
     ~MainComponent() override;
     void paint (juce::Graphics&) override;
     void resized() override;
@@ -78,27 +90,64 @@ public:
     void startPluginScan();
     void pluginScanner();
 
-    static constexpr double mySampleRate = 44100.0;
-    static constexpr int myBufferSize = 256;
+    void toggleTrace();
+    void tuneBufferSize();
+    void showSleepStats();
+    void updateWatchdog();
+    juce::String getBoardKey() const;
+    void openBoard();
+    void saveBoard (bool chooseFile, bool captureAll = true);
+    LooperProcessor* getLooper();
+
+    // What we ask the ASIO driver for. The graph runs at whatever the device
+    //  reports in audioDeviceAboutToStart().
+    static constexpr double preferredSampleRate = 44100.0;
+    static constexpr int preferredBufferSize = 256;
+    static constexpr int firstSceneMenuId = 100;
+    static constexpr int firstBlockSizeMenuId = 90;
+    static constexpr int fixedBlockSizes[] = { 16, 32, 64, 128, 256 };
+    static constexpr juce::uint32 autosaveIntervalMs = 60000;
+    static constexpr juce::uint32 captureIntervalMs = 250;      // one plugin state per tick
+    static constexpr double watchdogBudget = 0.5;       // share of the block a slot may take
 
 private:
+    LiveMode liveMode;                  // first, so memory is locked before anything else allocates
     AudioDeviceManager audioDeviceManager;
 
-    juce::Image backgroundImage;
+    BackgroundImageCache background { BinaryData::pedalboard_jpg, BinaryData::pedalboard_jpgSize,
+                                      [safe = juce::Component::SafePointer<MainComponent> (this)]
+                                      {
+                                          if (safe != nullptr)
+                                              safe->repaint();
+                                      } };
     juce::ComponentBoundsConstrainer constrainer;
 
     std::unique_ptr<juce::MenuBarComponent> menuBar;
 
     HorizontalMeter levelMeter;
-    bool peakReset;
-    std::atomic<float> currentLevel { -100.0f };
+    juce::Label dspLoadLabel;
 
     juce::AudioPluginFormatManager formatManager;
-
-    bool pluginsActive;
-
-    std::unique_ptr<juce::AudioPluginInstance> granularPlugin;
-    juce::AudioBuffer<float> granularPluginBuffer;
+    PluginScanCache pluginScanCache { formatManager, PluginScanCache::getDefaultCacheFile() };
+    PluginLoader pluginLoader { formatManager };
+
+    AudioProfiler audioProfiler;
+    BufferSizeTuner bufferTuner { audioDeviceManager, audioProfiler, BufferSizeTuner::getDefaultSettingsFile() };
+    int profiledScene = -1;
+    SignalGraph signalGraph;
+    juce::StringArray watchdogBypassed;     // shown in the status bar until restored
+    bool watchdogEnabled = true;
+    MidiController midiController;
+    std::array<MidiEvent, MidiController::maxEventsPerBlock> midiEvents;    // audio thread only
+    SceneCache sceneCache { signalGraph, pluginLoader };
+    BoardFileWriter boardWriter;
+    juce::File boardFile;
+    juce::uint32 lastAutosave = 0;
+    juce::uint32 lastCapture = 0;
+    std::unique_ptr<juce::FileChooser> fileChooser;
+    int granularSlot;
+    int looperSlot;
+    bool hostOutOfProcess = false;
     std::unique_ptr<PluginWindow> granularPluginWindow;
 
     std::unique_ptr<juce::DialogWindow> scanDialog;
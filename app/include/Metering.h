@@ -0,0 +1,119 @@
+// ****************************************************************************
+//     Filename: Metering.h
+// Date Created: 10/17/2026
+//
+//     Comments: Audio metering module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Levels measured at one point of the graph since the reader last reset the
+//   tap. All values are linear gain.
+
+struct MeterReading
+{
+    float peak = 0.0f;
+    float rms = 0.0f;
+    float truePeak = 0.0f;          // 4x oversampled, 0 unless enabled on the tap
+};
+
+// ****************************************************************************
+// A metering point. The audio thread folds every block into running maxima
+//   and a sum of squares and publishes them through a seqlock; readers never
+//   block it and always see the values of one and the same block. Resetting
+//   is a request the audio thread picks up on its next block, so a reader can
+//   never lose a peak that lands between its read and its reset.
+
+class MeterTap
+{
+public:
+
+    static constexpr int maxChannels = 2;
+    using Readings = std::array<MeterReading, (size_t) maxChannels>;
+
+    // Audio thread. Only one thread may measure a tap at a time.
+    void measure (const float* const* channels, int numChannels, int numSamples);
+
+    // Any thread
+    Readings read() const;
+    void reset()                                        { resetRequests.fetch_add (1, std::memory_order_relaxed); }
+    Readings readAndReset()                             { auto r = read(); reset(); return r; }
+
+    // Inter-sample peaks cost an 8 tap polyphase filter per sample, so they
+    //  are only worth it at the ends of the board
+    void setTruePeakEnabled (bool shouldMeasure)        { truePeakEnabled.store (shouldMeasure, std::memory_order_relaxed); }
+
+private:
+
+    static constexpr int truePeakHistory = 7;
+
+    static void measurePeakAndPower (const float* samples, int numSamples, float& peak, float& sumOfSquares);
+    static float measureTruePeak (const float* samples, int numSamples, std::array<float, truePeakHistory>& history);
+
+    // Audio thread only
+    std::array<float, maxChannels> peak {}, truePeak {};
+    std::array<double, maxChannels> sumOfSquares {};
+    juce::int64 numMeasured = 0;
+    std::array<std::array<float, truePeakHistory>, maxChannels> history {};
+    juce::uint32 handledResets = 0;
+
+    std::atomic<juce::uint32> resetRequests { 0 };
+    std::atomic<bool> truePeakEnabled { false };
+
+    // Odd while the audio thread is writing
+    std::atomic<juce::uint32> sequence { 0 };
+    std::array<std::atomic<float>, (size_t) maxChannels * 3> published {};
+};
+
+// ****************************************************************************
+// One tap per output port of every node of the running board: the input,
+//   path A and path B of the A/B switch, every plugin slot, the mixer and the
+//   mains (the output node's tap measures what it sends to the device).
+
+class MeterBank
+{
+public:
+
+    static constexpr int maxNodes = 64;
+
+    MeterBank() : taps ((size_t) maxNodes * 2) {}
+
+    static int tapFor (int node, int port = 0)          { return juce::isPositiveAndBelow (node, maxNodes) ? node * 2 + port : -1; }
+    int getNumTaps() const                              { return (int) taps.size(); }
+
+    MeterTap& getTap (int index)                        { return taps[(size_t) index]; }
+    MeterTap* getTapForNode (int node, int port = 0)    { const auto t = tapFor (node, port); return t >= 0 ? &taps[(size_t) t] : nullptr; }
+
+private:
+    std::vector<MeterTap> taps;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterBank)
+};
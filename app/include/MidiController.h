@@ -0,0 +1,119 @@
+// ****************************************************************************
+//     Filename: MidiController.h
+// Date Created: 10/17/2026
+//
+//     Comments: MIDI footswitch and expression pedal input
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "SignalGraph.h"
+
+// ****************************************************************************
+// Takes MIDI from the enabled input devices and hands it to the audio thread
+//   through a preallocated lock-free queue. A mapping layer turns footswitch
+//   presses into A/B switching, slot bypass and scene changes; anything it
+//   doesn't claim is passed on to the plugins.
+//
+// Events are positioned one block behind the time they arrived, so the audio
+//   thread sees them at the next callback with their spacing intact: a press
+//   is heard within one block. Nothing on the audio side allocates or locks.
+
+class MidiController final : public juce::MidiInputCallback
+{
+public:
+
+    enum class Trigger { controller, note, programChange };
+    enum class Action { forward, toggleAB, selectPath, toggleBypass, selectScene };
+
+    struct Mapping
+    {
+        Trigger trigger = Trigger::controller;
+        int channel = 0;            // 1 - 16, or 0 for any
+        int number = -1;            // controller or note number, -1 for any
+        Action action = Action::forward;
+        int target = -1;            // slot, path or scene, see below
+    };
+
+    // Targets: forward sends to one slot or, with -1, to every slot. A -1
+    //  selectPath follows the controller value and a -1 selectScene takes the
+    //  program number. Toggles fire on a press: a controller value of 64 or
+    //  more, or a note on.
+
+    MidiController();
+    ~MidiController() override;
+
+    static juce::File getDefaultMappingFile();
+    static juce::Array<Mapping> createDefaultMappings();
+
+    // Message thread
+    void setMappings (const juce::Array<Mapping>& newMappings);
+    juce::Array<Mapping> getMappings() const;
+    bool loadMappings (const juce::File& file);
+    bool saveMappings (const juce::File& file) const;
+
+    // The newest scene asked for since the last call, or -1
+    int takePendingScene()                              { return pendingScene.exchange (-1); }
+
+    // Before the audio callback starts
+    void prepare (double sampleRate);
+
+    // Audio thread. Takes everything that has arrived and positions it within
+    //  a block of numSamples. Returns the number of events written.
+    int popEvents (MidiEvent* events, int maxEvents, int numSamples);
+
+    static constexpr int maxEventsPerBlock = 256;
+
+private:
+
+    // MIDI thread. Reads the mappings and pushes under mappingLock, which is
+    //  what keeps the queue to one writer at a time.
+    void handleIncomingMidiMessage (juce::MidiInput* source, const juce::MidiMessage& message) override;
+
+    struct Queued
+    {
+        double timestamp;           // seconds, on the Time::getMillisecondCounterHiRes() clock
+        MidiEvent event;
+    };
+
+    void push (double timestamp, const MidiEvent& event);     // with mappingLock held
+    static bool matches (const Mapping& mapping, const juce::MidiMessage& message);
+    static bool isPress (const juce::MidiMessage& message);
+
+    static constexpr int queueSize = 1024;
+    juce::AbstractFifo fifo { queueSize };
+    std::array<Queued, queueSize> queue;
+    std::atomic<double> currentSampleRate { 44100.0 };
+    std::atomic<int> pendingScene { -1 };
+
+    juce::CriticalSection mappingLock;      // message and MIDI threads only, also serialises push()
+    juce::Array<Mapping> mappings;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiController)
+};
@@ -0,0 +1,88 @@
+// ****************************************************************************
+//     Filename: OfflineRenderer.h
+// Date Created: 10/17/2026
+//
+//     Comments: Headless offline render module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "SignalGraph.h"
+#include "PluginLoader.h"
+
+struct SceneRecipe;
+
+// ****************************************************************************
+// Pushes an audio file through the same SignalGraph the audio callback uses,
+//   block by block and as fast as the CPU allows, without opening an audio
+//   device. Used from the command line to render boards and to measure how
+//   much headroom the graph has:
+//
+//   MoodBoard --render in.wav [--board x.moodboard] [--out out.wav]
+//             [--block 64,128,256] [--pipelined]
+
+class OfflineRenderer final
+{
+public:
+
+    struct Result
+    {
+        int blockSize = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+
+        double getRealtimeFactor() const    { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+    };
+
+    OfflineRenderer();
+
+    // Plugins are created synchronously. Without a board file we render the
+    //  default board with just the looper loaded.
+    bool loadBoard (const juce::File& file, double sampleRate, int maxBlockSize, juce::String& error);
+    bool loadDefaultBoard (double sampleRate, int maxBlockSize, juce::String& error);
+
+    void setPipelined (bool shouldPipeline)                 { signalGraph.setPipelined (shouldPipeline); }
+
+    // Renders all of input, compensating for the graph latency so that output
+    //  lines up with it sample for sample. output is resized to stereo.
+    Result render (const juce::AudioBuffer<float>& input, double sampleRate, int blockSize,
+                   juce::AudioBuffer<float>& output);
+
+    static int run (const juce::StringArray& args);
+
+private:
+
+    bool installScene (const SceneRecipe& recipe, double sampleRate, int maxBlockSize, juce::String& error);
+
+    juce::AudioPluginFormatManager formatManager;
+    PluginLoader pluginLoader { formatManager };
+    SignalGraph signalGraph;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,94 @@
+// ****************************************************************************
+//     Filename: PluginLoader.h
+// Date Created: 10/17/2026
+//
+//     Comments: Background plugin loader module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Loads plugin instances without blocking the UI or the audio callback.
+//   Plugins hosted in this process have to be created, restored and prepared
+//   on the message thread (VST3 asserts it), so the background thread only
+//   reads their binaries into the file cache and then hands them over to the
+//   format's async creation. Sandboxed plugins and our own built-in nodes
+//   are created and prepared entirely on the background thread.
+
+class PluginLoader final : private juce::Thread
+{
+public:
+
+    // Called on the message thread. instance is null on failure.
+    using Callback = std::function<void (std::unique_ptr<juce::AudioPluginInstance> instance, const juce::String& error)>;
+
+    explicit PluginLoader (juce::AudioPluginFormatManager& formats);
+    ~PluginLoader() override;
+
+    // state, if not empty, is restored before the instance is prepared
+    void load (const juce::PluginDescription& description, const juce::MemoryBlock& state,
+               double sampleRate, int blockSize, bool outOfProcess, Callback onLoaded);
+
+    // Does the same work on the calling thread, for when there is nothing
+    //  to keep responsive (offline renders). Must be the message thread
+    //  unless the plugin is sandboxed or built in.
+    std::unique_ptr<juce::AudioPluginInstance> loadNow (const juce::PluginDescription& description,
+                                                        const juce::MemoryBlock& state, double sampleRate,
+                                                        int blockSize, bool outOfProcess, juce::String& error);
+
+private:
+
+    struct Job
+    {
+        juce::PluginDescription description;
+        juce::MemoryBlock state;
+        double sampleRate = 44100.0;
+        int blockSize = 256;
+        bool outOfProcess = false;
+        Callback onLoaded;
+    };
+
+    void run() override;
+    void createOnMessageThread (Job job);
+    std::unique_ptr<juce::AudioPluginInstance> prepareInstance (const Job& job, juce::String& error);
+    std::unique_ptr<juce::AudioPluginInstance> createInstance (const Job& job, juce::String& error);
+    static void finishInstance (juce::AudioPluginInstance& instance, const Job& job, double startTime);
+    juce::AudioPluginFormat* findFormat (const juce::PluginDescription& description) const;
+
+    static constexpr int stopTimeoutMs = 30000;
+
+    juce::AudioPluginFormatManager& formatManager;
+
+    juce::CriticalSection jobLock;
+    std::deque<Job> jobs;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (PluginLoader)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginLoader)
+};
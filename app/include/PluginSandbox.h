@@ -0,0 +1,215 @@
+// ****************************************************************************
+//     Filename: PluginSandbox.h
+// Date Created: 10/17/2026
+//
+//     Comments: Out-of-process plugin scanning and hosting module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedAudioRing.h"
+#include "PluginWindow.h"
+
+// ****************************************************************************
+// MoodBoard can relaunch itself as a child process to scan or host a plugin,
+//   so a plugin that hangs or crashes takes down the child and not the board.
+//   Control messages (load, prepare, state, editor) are small XML documents
+//   sent over the JUCE child process pipe; audio goes through a
+//   SharedAudioRing and never touches the pipe.
+
+struct PluginSandbox
+{
+    static constexpr const char* processUID = "moodboardsandbox";
+
+    enum class ScanResult { ok, failed, unavailable };
+
+    // Probes one plugin file in a throwaway child process. Returns failed if
+    //  the child crashed or hung, unavailable if it could not be launched.
+    static ScanResult scanFile (const juce::String& formatName, const juce::String& fileOrIdentifier,
+                                juce::OwnedArray<juce::PluginDescription>& results);
+
+    // MoodBoard --sandbox-bench [plugin file]
+    //  Compares per-block latency and CPU cost of in-process and sandboxed
+    //  hosting, using a built-in gain plugin when no file is given.
+    static int runBenchmark (const juce::StringArray& args);
+
+    static juce::MemoryBlock toMessage (const juce::XmlElement& xml);
+    static std::unique_ptr<juce::XmlElement> fromMessage (const juce::MemoryBlock& message);
+    static juce::int64 getProcessCpuMicroseconds();
+};
+
+// ****************************************************************************
+// Child side: lives in the sandbox process and owns the real plugin instance.
+//   Whenever the plugin reports a change its state is pushed to the host
+//   unasked, so the host can save it without a round trip.
+
+class PluginSandboxWorker final : public juce::ChildProcessWorker,
+                                  private juce::AudioProcessorListener,
+                                  private juce::Timer
+{
+public:
+
+    PluginSandboxWorker();
+    ~PluginSandboxWorker() override;
+
+    void handleMessageFromCoordinator (const juce::MemoryBlock& message) override;
+    void handleConnectionLost() override;
+
+private:
+
+    class AudioThread;
+
+    static constexpr int statePushIntervalMs = 250;
+
+    void handleMessage (const juce::XmlElement& message);
+    void stopAudio();
+
+    void audioProcessorParameterChanged (juce::AudioProcessor*, int, float) override   { stateChanged = true; }
+    void audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails& details) override;
+    void timerCallback() override;
+
+    juce::AudioPluginFormatManager formatManager;
+    std::unique_ptr<juce::AudioPluginInstance> plugin;
+    std::unique_ptr<SharedAudioRing> ring;
+    std::unique_ptr<AudioThread> audioThread;
+    std::unique_ptr<PluginWindow> editorWindow;
+    std::atomic<bool> stateChanged { false };   // set from whichever thread the plugin reports on
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginSandboxWorker)
+};
+
+// ****************************************************************************
+// Host side: launches a sandbox process and exchanges request/reply messages
+//   with it. Replies arrive on the pipe's own thread, so request() may be
+//   called from any thread except the audio thread. States the child pushes
+//   are kept for getPushedState(), which never waits.
+
+class PluginSandboxConnection final : public juce::ChildProcessCoordinator
+{
+public:
+
+    PluginSandboxConnection() = default;
+    ~PluginSandboxConnection() override;
+
+    bool launch();
+    bool isConnected() const                            { return connected.load(); }
+
+    std::unique_ptr<juce::XmlElement> request (juce::XmlElement message, int timeoutMs);
+    juce::MemoryBlock getPushedState() const;
+
+    void handleMessageFromWorker (const juce::MemoryBlock& message) override;
+    void handleConnectionLost() override;
+
+private:
+    juce::CriticalSection requestLock, replyLock;
+    juce::WaitableEvent replyArrived;
+    std::unique_ptr<juce::XmlElement> reply;
+    juce::MemoryBlock pushedState;
+    int nextRequestId = 0;
+    int expectedReplyId = -1;
+    std::atomic<bool> connected { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginSandboxConnection)
+};
+
+// ****************************************************************************
+// Stands in for a plugin that runs in a sandbox process. It drops into a
+//   graph slot like any other AudioPluginInstance. The host waits only a
+//   short while for each block; once the child misses that, it runs one block
+//   behind until the child keeps up again, which is checked every so often.
+//   The extra block isn't reported as latency, since it only lasts as long
+//   as the child is overloaded. If the child dies, or falls behind even
+//   that, blocks pass through dry instead of stalling the board.
+
+class SandboxedPlugin final : public juce::AudioPluginInstance
+{
+public:
+
+    static std::unique_ptr<SandboxedPlugin> create (const juce::PluginDescription& description,
+                                                    double sampleRate, int blockSize, juce::String& error);
+    ~SandboxedPlugin() override;
+
+    bool isAlive() const                                { return connection->isConnected(); }
+    int getNumLateBlocks() const                        { return lateBlocks.load(); }
+    void showEditorWindow();
+
+    // Returns the child's CPU time so far, or -1 if it didn't answer
+    juce::int64 getSandboxCpuMicroseconds();
+
+    void fillInPluginDescription (juce::PluginDescription& d) const override   { d = description; }
+    const juce::String getName() const override                                 { return description.name; }
+
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+    void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi) override;
+
+    double getTailLengthSeconds() const override        { return tailLengthSeconds; }
+    bool acceptsMidi() const override                   { return false; }
+    bool producesMidi() const override                  { return false; }
+
+    // The editor opens in the child process, see showEditorWindow()
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override                     { return false; }
+
+    int getNumPrograms() override                       { return 1; }
+    int getCurrentProgram() override                    { return 0; }
+    void setCurrentProgram (int) override               {}
+    const juce::String getProgramName (int) override    { return {}; }
+    void changeProgramName (int, const juce::String&) override {}
+
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    // The state the child last pushed, without asking it. May lag a change
+    //  by a fraction of a second.
+    void getPushedState (juce::MemoryBlock& destData) const   { destData = connection->getPushedState(); }
+
+private:
+
+    SandboxedPlugin (const juce::PluginDescription& description, std::unique_ptr<PluginSandboxConnection> connection);
+
+    static constexpr int requestTimeoutMs = 10000;
+    static constexpr int resyncProbeInterval = 64;      // blocks
+
+    juce::PluginDescription description;
+    std::unique_ptr<PluginSandboxConnection> connection;
+
+    juce::File ringFile;
+    std::unique_ptr<SharedAudioRing> ring;
+    std::atomic<bool> ringReady { false };
+    uint32_t nextSequence = 0;                          // audio thread only
+    bool runningLate = false;                           // audio thread only, see processBlock()
+    int blocksSinceProbe = 0;                           // audio thread only
+    int responseTimeoutMicroseconds = 0;
+    double tailLengthSeconds = 0.0;
+
+    std::atomic<int> lateBlocks { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SandboxedPlugin)
+};
@@ -0,0 +1,97 @@
+// ****************************************************************************
+//     Filename: PluginScanCache.h
+// Date Created: 10/17/2026
+//
+//     Comments: Persistent plugin scan cache module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// Scans the default plugin search paths of every registered format on
+//   background threads and keeps the results in a KnownPluginList that is
+//   persisted to disk. Each plugin file is stamped with its path, size and
+//   modification time, so later launches only re-probe bundles that changed.
+//   Files that fail to load are blacklisted until they change. Probing happens
+//   in sandbox child processes where possible, so a plugin that hangs or
+//   crashes while being scanned can't take MoodBoard down with it.
+
+class PluginScanCache final : private juce::Thread
+{
+public:
+
+    PluginScanCache (juce::AudioPluginFormatManager& formats, const juce::File& cacheFile);
+    ~PluginScanCache() override;
+
+    // onFinished is called on the message thread once the list is up to date
+    void startScan (std::function<void()> onFinished);
+    bool isScanning() const                             { return isThreadRunning(); }
+
+    void setScanOutOfProcess (bool shouldScanOutOfProcess) { scanOutOfProcess = shouldScanOutOfProcess; }
+
+    juce::KnownPluginList& getKnownPlugins()            { return knownPlugins; }
+    const juce::KnownPluginList& getKnownPlugins() const { return knownPlugins; }
+
+    // Finds the first known plugin whose name matches, ignoring case
+    std::unique_ptr<juce::PluginDescription> findPlugin (const juce::String& name) const;
+
+    static juce::File getDefaultCacheFile();
+
+private:
+
+    struct FileStamp
+    {
+        juce::int64 size = 0;
+        juce::int64 modificationTime = 0;
+
+        bool operator== (const FileStamp& other) const  { return size == other.size && modificationTime == other.modificationTime; }
+    };
+
+    static FileStamp stampFor (const juce::String& fileOrIdentifier);
+
+    void run() override;
+    void loadCache();
+    void saveCache();
+    void forgetFile (const juce::String& fileOrIdentifier);
+    void probeFile (juce::AudioPluginFormat& format, const juce::String& fileOrIdentifier);
+
+    juce::AudioPluginFormatManager& formatManager;
+    juce::File cacheFile;
+    juce::KnownPluginList knownPlugins;
+
+    juce::CriticalSection stampLock;
+    std::map<juce::String, FileStamp> stamps;
+
+    std::atomic<bool> scanOutOfProcess { true };
+    juce::ThreadPool probePool;
+    std::function<void()> scanFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginScanCache)
+};
@@ -0,0 +1,113 @@
+// ****************************************************************************
+//     Filename: RealtimeThreadPool.h
+// Date Created: 10/17/2026
+//
+//     Comments: Real-time worker pool module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// A small pool of pre-spawned real-time worker threads that the audio callback
+//   can fan independent work out to. run() publishes a batch of tasks, helps
+//   execute them on the calling thread and then waits at a barrier that spins
+//   briefly before falling back to a futex wait (std::atomic::wait).
+//
+// Nothing in run() allocates or takes a lock, so it is safe to call from the
+//   audio thread. Only one thread may call run() at a time.
+//
+// Workers always run with denormals flushed to zero. For live use they can
+//   also be pinned to cores, one each, and run SCHED_FIFO.
+
+class RealtimeThreadPool
+{
+public:
+
+    using TaskFunction = void (*) (void* context, int taskIndex);
+
+    RealtimeThreadPool (int numWorkers, double sampleRate, int blockSize,
+                        const juce::Array<int>& cores = {}, int fifoPriority = 0);
+    ~RealtimeThreadPool();
+
+    int getNumWorkers() const                           { return workers.size(); }
+
+    // How many workers got what they asked for, once they've started
+    int getNumPinnedWorkers() const                     { return numPinned.load(); }
+    int getNumFifoWorkers() const                       { return numFifo.load(); }
+
+    // Runs taskFunction (context, 0 .. numTasks - 1) and returns once every
+    //  task has completed.
+    void run (int numTasks, TaskFunction taskFunction, void* context);
+
+    // Leaves one core for the device thread and one for the message thread
+    static int getDefaultNumWorkers();
+
+    // For the calling thread. Linux only, elsewhere they return false.
+    static bool pinCurrentThread (int core);
+    static bool setCurrentThreadFifo (int priority);
+
+    // Touches the next stackBytes of the calling thread's stack so that
+    //  locked memory covers it before it's needed
+    static void prefaultStack();
+    static constexpr size_t stackBytes = 128 * 1024;
+
+    static constexpr int maxWorkers = 7;
+    static constexpr int maxTasks = 0xffff;
+
+private:
+
+    class Worker;
+
+    // The work word packs (generation << 32) | (numTasks << 16) | nextTask so
+    //  a claim is only ever made against the batch it was meant for.
+    static uint64_t makeWork (uint32_t generation, int numTasks)     { return ((uint64_t) generation << 32) | ((uint64_t) numTasks << 16); }
+    static uint32_t generationOf (uint64_t work)                     { return (uint32_t) (work >> 32); }
+    static int numTasksOf (uint64_t work)                            { return (int) ((work >> 16) & 0xffff); }
+    static int nextTaskOf (uint64_t work)                            { return (int) (work & 0xffff); }
+
+    bool runOneTask (uint64_t& observedWork);
+    void waitForWork (uint64_t observedWork) const;
+
+    static void cpuRelax() noexcept;
+
+    static constexpr int spinIterations = 2000;
+
+    std::atomic<uint64_t> work { 0 };
+    std::atomic<int> tasksRemaining { 0 };
+    std::atomic<TaskFunction> currentFunction { nullptr };
+    std::atomic<void*> currentContext { nullptr };
+    std::atomic<bool> shuttingDown { false };
+    std::atomic<int> numPinned { 0 };
+    std::atomic<int> numFifo { 0 };
+
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeThreadPool)
+};
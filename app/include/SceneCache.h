@@ -0,0 +1,126 @@
+// ****************************************************************************
+//     Filename: SceneCache.h
+// Date Created: 10/17/2026
+//
+//     Comments: Preloaded board scene cache module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "SignalGraph.h"
+#include "PluginLoader.h"
+#include "BoardFile.h"
+
+// ****************************************************************************
+// Keeps board scenes warm: every plugin of a warm scene is instantiated and
+//   prepared inside the SignalGraph, so recalling it costs one schedule
+//   exchange at the next block boundary. Memory is bounded by keeping at most
+//   maxWarmScenes loaded; the least recently used idle scene beyond that is
+//   captured (plugin descriptions and state) and unloaded. Recalling a cold
+//   scene reloads it in the background and switches once it is ready.
+
+class SceneCache
+{
+public:
+
+    SceneCache (SignalGraph& graph, PluginLoader& loader);
+
+    // Snapshots the running board into a new warm scene and returns its index
+    int storeCurrentScene (const juce::String& name);
+
+    // Re-captures the plugin states of a loaded scene
+    void captureScene (int index);
+
+    // Message thread, call regularly. Re-captures one slot of a loaded scene
+    //  per call, working round the board, and flags unsaved changes when its
+    //  state differs from the last capture. Sandboxed plugins hand over the
+    //  state their child last pushed, so neither of these waits on a sandbox.
+    void captureNextSlot();
+    bool hasUnsavedChanges() const;
+
+    void recallScene (int index);
+
+    // Replaces every scene with the ones from a board. The old scenes keep
+    //  playing until the board's current scene has loaded.
+    void loadBoard (std::vector<SceneRecipe> scenes, int currentScene);
+
+    // Captures every loaded scene for saving, or with captureAll false uses
+    //  the states captureNextSlot() has already picked up. Cold scenes are
+    //  passed on as they are, including state that was never read back from a
+    //  board file. Clears the unsaved changes flag.
+    std::vector<SceneRecipe> createSnapshot (int& currentScene, bool captureAll);
+
+    // Reads every state still waiting in a board file into memory, so that
+    //  nothing keeps the file mapped while it is being saved over
+    void releaseBoardFile (const juce::File& file);
+
+    int getNumScenes() const                            { return (int) records.size(); }
+    juce::String getSceneName (int index) const         { return records[(size_t) index].name; }
+    bool isSceneWarm (int index) const                  { return records[(size_t) index].warm; }
+    bool isSceneDiscarded (int index) const             { return records[(size_t) index].discarded; }
+
+    void setMaxWarmScenes (int maximum)                 { maxWarmScenes = juce::jmax (1, maximum); }
+
+    // Message thread, call regularly. Unloads scenes over budget once the
+    //  audio thread has moved off them.
+    void collectGarbage();
+
+private:
+
+    struct SceneRecord
+    {
+        juce::String name;
+        std::vector<SlotRecipe> plugins;
+        bool warm = false;
+        bool discarded = false;         // removed once the audio thread is done with it
+        int pendingLoads = 0;
+        int generation = 0;             // bumped on unload, so stale loads are dropped
+        juce::uint32 lastUsed = 0;
+        bool recallWhenWarm = false;
+    };
+
+    void captureSlot (int index, int slot);
+    void warmScene (int index);
+    void sceneLoaded (int index);
+    int indexOf (const BoardScene* scene) const;
+
+    SignalGraph& signalGraph;
+    PluginLoader& pluginLoader;
+
+    std::vector<SceneRecord> records;   // parallel to the SignalGraph scenes, indices shift on removal
+    int maxWarmScenes = 4;
+    juce::uint32 useCounter = 0;
+    int nextCaptureScene = 0;
+    int nextCaptureSlot = 0;
+    bool unsavedChanges = false;
+    const BoardScene* savedScene = nullptr;     // current when last saved or loaded, only compared
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (SceneCache)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SceneCache)
+};
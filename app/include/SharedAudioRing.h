@@ -0,0 +1,117 @@
+// ****************************************************************************
+//     Filename: SharedAudioRing.h
+// Date Created: 10/17/2026
+//
+//     Comments: Shared-memory audio transport module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+
+// ****************************************************************************
+// A ring of audio blocks in memory shared between MoodBoard and a sandbox
+//   child process. The host writes a block into a slot and publishes its
+//   sequence number; the child processes the slot in place and publishes the
+//   same number back. Both sides spin briefly and then sleep: on a futex on
+//   Linux, on a named event per sequence word on Windows, and in short
+//   sleeps elsewhere, so a round trip costs a few microseconds and an idle
+//   ring doesn't burn a core.
+//
+// The mapping is backed by a file, placed in /dev/shm where available so it
+//   never touches the disk. On Linux the file is named after the host's
+//   process id, so rings left by a host that crashed can be found and removed.
+
+class SharedAudioRing
+{
+public:
+
+    static constexpr int numSlots = 4;
+    static constexpr int maxChannels = 8;
+
+    ~SharedAudioRing();
+
+    // The host creates the mapping, the child opens it by file name
+    static std::unique_ptr<SharedAudioRing> create (const juce::File& file, int maxBlockSize, int numChannels);
+    static std::unique_ptr<SharedAudioRing> open (const juce::File& file);
+    static juce::File createBackingFile();
+    static void removeStaleFiles();
+
+    int getMaxBlockSize() const                         { return header->maxBlockSize; }
+    int getNumChannels() const                          { return header->numChannels; }
+    float* getChannel (uint32_t sequence, int channel) const;
+
+    // Host side
+    void submitRequest (uint32_t sequence, int numSamples);
+    bool waitForResponse (uint32_t sequence, int timeoutMicroseconds);
+
+    // Child side
+    bool waitForRequest (uint32_t lastHandled, int timeoutMicroseconds);
+    uint32_t getLatestRequest() const                   { return header->request.load (std::memory_order_acquire); }
+    int getNumSamples (uint32_t sequence) const         { return header->slotSamples[sequence % numSlots]; }
+    void submitResponse (uint32_t sequence);
+
+    void requestShutdown();
+    bool isShutdown() const                             { return header->shutdown.load (std::memory_order_acquire) != 0; }
+
+private:
+
+    struct Header
+    {
+        uint32_t magic;
+        int32_t maxBlockSize;
+        int32_t numChannels;
+        alignas (64) std::atomic<uint32_t> request;
+        alignas (64) std::atomic<uint32_t> response;
+        alignas (64) std::atomic<uint32_t> shutdown;
+        int32_t slotSamples[numSlots];
+    };
+
+    static constexpr uint32_t ringMagic = 0x4d425247;  // 'MBRG'
+    static constexpr size_t headerSize = 4096;
+    static constexpr int spinIterations = 1000;
+
+    static size_t getMappingSize (int maxBlockSize, int numChannels);
+    bool waitUntil (std::atomic<uint32_t>& word, uint32_t target, int timeoutMicroseconds) const;
+    void futexWait (std::atomic<uint32_t>& word, uint32_t expected, int timeoutMicroseconds) const;
+    void futexWake (std::atomic<uint32_t>& word) const;
+
+    SharedAudioRing (const juce::File& file, std::unique_ptr<juce::MemoryMappedFile> mappedFile);
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    Header* header = nullptr;
+    float* audio = nullptr;
+
+   #if JUCE_WINDOWS
+    // Named after the backing file, so both processes open the same pair
+    void* requestEvent = nullptr;
+    void* responseEvent = nullptr;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedAudioRing)
+};
@@ -0,0 +1,539 @@
+// ****************************************************************************
+//     Filename: SignalGraph.h
+// Date Created: 10/17/2026
+//
+//     Comments: Board signal graph and compiled schedule module header
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+#pragma once
+
+#include <JuceHeader.h>
+#include "RealtimeThreadPool.h"
+#include "Metering.h"
+#include "GarbageCollector.h"
+
+class AudioProfiler;
+
+// ****************************************************************************
+// The kinds of node a board can be built from. A slot holds an optional
+//   plugin instance and passes audio straight through while it is empty.
+
+enum class NodeKind
+{
+    input,          // mono guitar input, duplicated to stereo
+    abSwitch,       // one input, two outputs (path A / path B), crossfaded
+    slot,           // plugin slot
+    mixer,          // sums all of its inputs
+    output          // stereo mains output
+};
+
+struct GraphNode
+{
+    NodeKind kind;
+    juce::String name;
+    int slot = -1;                  // index into the slot table for NodeKind::slot
+};
+
+struct GraphEdge
+{
+    int source;
+    int sourcePort;                 // 0 for everything except the A/B switch
+    int dest;
+};
+
+// ****************************************************************************
+// Editable description of a board. This lives on the message thread and is
+//   never touched by the audio callback; it is turned into a CompiledGraph.
+
+class BoardTopology
+{
+public:
+
+    int addNode (NodeKind kind, const juce::String& name, int slot = -1);
+    void connect (int source, int dest, int sourcePort = 0);
+
+    const std::vector<GraphNode>& getNodes() const      { return nodes; }
+    const std::vector<GraphEdge>& getEdges() const      { return edges; }
+
+    // The README board: A/B switch -> Path A (Looper -> Granular -> Delay ->
+    //  Reverb) and Path B (Multi-FX) -> mixer -> mains.
+    static BoardTopology createDefaultBoard();
+
+private:
+    std::vector<GraphNode> nodes;
+    std::vector<GraphEdge> edges;
+};
+
+// ****************************************************************************
+// The part of a slot the audio thread works on. It outlives any one compiled
+//   schedule, so a plugin can be swapped without recompiling: the message
+//   thread parks the new instance in incoming and the audio thread picks it up
+//   at the next block boundary, crossfading from the old one.
+
+struct SlotProcessor
+{
+    enum SwapState { idle, requested, fading, finished };
+
+    // Plugins may add events, so the MIDI buffer gets some room up front
+    SlotProcessor()                                     { midi.ensureSize (2048); }
+
+    // Message thread marks a swap requested and sends the plugin through the
+    //  command queue, the audio thread reports back through swapState
+    std::atomic<int> swapState { idle };
+
+    // A bypassed slot passes its input through, ramping over one block
+    std::atomic<bool> bypassed { false };
+
+    // Set by the audio thread when the deadline watchdog bypasses the slot,
+    //  moved on to reported once the message thread has told the user
+    enum WatchdogState { clear, tripped, reported };
+    std::atomic<int> watchdogState { clear };
+
+    // Sleep statistics, in samples since the slot was created
+    std::atomic<juce::int64> processedSamples { 0 };
+    std::atomic<juce::int64> sleptSamples { 0 };
+    std::atomic<int> wakeups { 0 };
+
+    // Audio thread only
+    juce::AudioPluginInstance* incoming = nullptr;
+    bool swapPending = false;
+    juce::AudioPluginInstance* current = nullptr;
+    juce::AudioPluginInstance* fadingOut = nullptr;
+    int fadeLength = 1;
+    int fadePosition = 0;
+    bool wasBypassed = false;
+    bool asleep = false;
+    int quietSamples = 0;
+    int overruns = 0;
+    int samplesSinceOverrun = 0;
+    juce::MidiBuffer midi;
+};
+
+// ****************************************************************************
+struct PluginSlot
+{
+    juce::String name;
+    std::unique_ptr<juce::AudioPluginInstance> plugin;
+    std::unique_ptr<SlotProcessor> processor;
+
+    // Message thread bookkeeping for a swap in flight
+    std::unique_ptr<juce::AudioPluginInstance> outgoing;
+    std::unique_ptr<juce::AudioPluginInstance> queued;
+    bool hasQueued = false;
+};
+
+// ****************************************************************************
+// A complete board configuration: a topology and the plugins in its slots.
+//   Only one scene runs at a time, but others can be kept instantiated and
+//   prepared so that switching to one is just a new schedule for the audio
+//   thread to pick up.
+
+struct BoardScene
+{
+    juce::String name;
+    BoardTopology topology;
+    std::vector<PluginSlot> slots;
+};
+
+// ****************************************************************************
+// One entry of the flat execution schedule. The audio thread switches on op
+//   and only ever indexes into the preallocated buffer pool. A slot or mixer
+//   whose output buffer is also its first input works in place.
+
+enum class StepOp : uint8_t { readInput, abSwitch, process, mix, writeOutput };
+
+struct GraphStep
+{
+    static constexpr int maxInputs = 8;
+
+    StepOp op = StepOp::process;
+    int node = -1;
+    SlotProcessor* slot = nullptr;
+    int slotIndex = -1;
+
+    int numInputs = 0;
+    std::array<int, maxInputs> inputs {};
+    std::array<int, 2> outputs { -1, -1 };
+
+    // Pipelined stages swap between two buffers on alternate blocks
+    bool pipelined = false;
+    int fixedBlockSize = 0;
+    int reblockSize = 0;            // fixedBlockSize as of the last prepare()
+    std::array<int, 2> parityInputs { -1, -1 };
+    std::array<int, 2> parityOutputs { -1, -1 };
+
+    // Blocks each mixer input is held back by so that inputs from pipelined
+    //  chains of different lengths line up, and where its delay lines start
+    std::array<int, maxInputs> inputDelays {};
+    int firstDelayLine = -1;
+
+    // Side of the A/B switch the step is on, or -1. An exit hands the path's
+    //  audio on to the rest of the board and tracks how long it's been silent.
+    int path = -1;
+    bool pathExit = false;
+    int quietSamples = 0;
+
+    // How long a slot's output has to stay silent, with silence going in,
+    //  before its plugin is put to sleep. -1 never sleeps.
+    int sleepAfterSamples = -1;
+};
+
+// ****************************************************************************
+// Steps are grouped into tasks (a contiguous run of steps) and tasks into
+//   phases. Phases run one after another; the tasks inside a parallel phase are
+//   independent branches and are handed to the worker pool together.
+
+struct GraphTask
+{
+    int firstStep = 0;
+    int numSteps = 0;
+    int scratchBuffer = -1;         // holds the outgoing plugin's block during a swap
+};
+
+struct GraphPhase
+{
+    int firstTask = 0;
+    int numTasks = 0;
+};
+
+// ****************************************************************************
+class CompiledGraph
+{
+public:
+
+    CompiledGraph (int numBuffers, int numChannels, int maxBlockSize);
+
+    float* getChannel (int buffer, int channel) const   { return channelPointers[(size_t) (buffer * channelsPerBuffer + channel)]; }
+    juce::AudioBuffer<float>& getView (int buffer, int numSamples);
+    void copyBuffer (int source, int dest, int numSamples) const;
+    void clearBuffer (int dest, int numSamples) const;
+    bool isSilent (int buffer, int numSamples, float threshold) const;
+
+    // Points deviceBuffer's first two channels at the device outputs for the
+    //  coming block, or back at the pool if the device can't take them
+    void attachDeviceOutputs (float* const* outputChannelData, int numOutputChannels, int offset);
+
+    // Audio thread, when this graph takes over from previous
+    void takeReblockState (const CompiledGraph& previous);
+
+    // Audio thread. Sends source through a delay line of whole blocks into
+    //  dest, adding to it or replacing it. Source and dest may be the same.
+    void delayBuffer (int line, int source, int dest, bool add, int numSamples);
+
+    std::vector<GraphStep> steps;
+    std::vector<GraphTask> tasks;
+    std::vector<GraphPhase> phases;
+    const int channelsPerBuffer;
+    const int maxBlockSize;
+    const BoardScene* scene = nullptr;  // the scene whose slots the steps point at
+    int latencySamples = 0;         // added by pipelined chains and re-blocking
+    int blockParity = 0;            // audio thread only
+    int deviceBuffer = -1;          // the buffer the output node reads, or -1
+
+    // Fixed block mode: device audio is gathered into reblockInput and played
+    //  out of reblockOutput, one block behind
+    int reblockSize = 0;
+    int reblockPosition = 0;        // audio thread only
+    juce::AudioBuffer<float> reblockInput, reblockOutput;
+
+    struct DelayLine
+    {
+        juce::AudioBuffer<float> blocks;    // channelsPerBuffer channels per block
+        int numBlocks = 1;
+        int position = 0;                   // audio thread only
+    };
+    std::vector<DelayLine> delayLines;
+
+private:
+    juce::AudioBuffer<float> pool;
+    std::vector<float*> channelPointers;
+    std::vector<juce::AudioBuffer<float>> views;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompiledGraph)
+};
+
+// ****************************************************************************
+// A MIDI message or mapped control action handed to process(), positioned
+//   within the block it arrives with. Messages go to one slot, or to all of
+//   them when target is -1; actions take effect from that block on.
+
+struct MidiEvent
+{
+    enum class Kind : uint8_t { message, toggleAB, selectPath, toggleBypass };
+
+    Kind kind = Kind::message;
+    int position = 0;
+    int target = -1;                // slot, or path for selectPath
+    int size = 0;
+    std::array<juce::uint8, 3> data {};
+};
+
+// ****************************************************************************
+// Owns the board scenes and their plugin slots, compiles the current scene
+//   into a flat schedule on the message thread and hands that schedule to the
+//   audio thread through an atomic pointer. process() never allocates, locks
+//   or dispatches virtually per edge. Independent branches (Path A and Path B)
+//   run concurrently on the worker pool.
+
+class SignalGraph
+{
+public:
+
+    SignalGraph();
+    ~SignalGraph();
+
+    // These all work on the current scene
+    void setTopology (BoardTopology newTopology);
+    const BoardTopology& getTopology() const            { return scenes[(size_t) currentScene]->topology; }
+
+    int getNumSlots() const                             { return (int) scenes[(size_t) currentScene]->slots.size(); }
+    int findSlot (const juce::String& name) const;
+    PluginSlot& getSlot (int index)                     { return scenes[(size_t) currentScene]->slots[(size_t) index]; }
+
+    // Hands an already prepared instance to the audio thread, which crossfades
+    //  to it at the next block boundary. The old instance is freed from
+    //  collectGarbage() once the fade is over.
+    void swapSlotPlugin (int index, std::unique_ptr<juce::AudioPluginInstance> instance);
+    bool isSwapInProgress (int index) const;
+    void setCrossfadeMs (double milliseconds);
+
+    // A slot whose plugin takes longer than this share of the block period
+    //  several times in a short while is bypassed, so one spiking plugin
+    //  can't take the whole output down. 0 turns the watchdog off.
+    void setWatchdogBudget (double shareOfBlock)        { watchdogBudget.store (juce::jmax (0.0, shareOfBlock)); }
+    double getWatchdogBudget() const                    { return watchdogBudget.load(); }
+
+    // Message thread. Names the slots bypassed since the last call, and puts
+    //  the current scene's bypassed slots back in the signal path.
+    juce::StringArray takeWatchdogTrips();
+    void restoreWatchdogBypasses();
+
+    // Scenes. Selecting one compiles it and hands it over at the next block
+    //  boundary, so its plugins must already be loaded and prepared.
+    int addScene (const juce::String& name, BoardTopology sceneTopology);
+    int getNumScenes() const                            { return (int) scenes.size(); }
+    BoardScene& getScene (int index)                    { return *scenes[(size_t) index]; }
+    int getCurrentScene() const                         { return currentScene; }
+    bool selectScene (int index);
+
+    // A scene is idle when it isn't current and the audio thread has moved on
+    //  from it. Only idle scenes can have plugins installed or unloaded
+    //  directly, without going through the audio thread.
+    bool isSceneIdle (int index) const;
+    bool setScenePlugin (int scene, int slot, std::unique_ptr<juce::AudioPluginInstance> instance);
+    bool unloadScene (int index);
+    bool removeScene (int index);
+
+    // Re-prepares every loaded plugin on the calling thread, keeping the
+    //  instances and their state. Call it from the message thread while
+    //  process() can't run, e.g. from audioDeviceAboutToStart(). This used to
+    //  spread the plugins over the worker pool; that was dropped on purpose,
+    //  because plugin formats expect prepareToPlay() on the message thread,
+    //  so don't move it back there to save time.
+    void prepare (double sampleRate, int maxBlockSize);
+    void releaseResources();
+
+    // Message thread
+    bool rebuild();
+    void collectGarbage();
+
+    // Audio thread
+    void process (const float* const* inputChannelData, int numInputChannels,
+                  float* const* outputChannelData, int numOutputChannels, int numSamples,
+                  const MidiEvent* midiEvents = nullptr, int numMidiEvents = 0);
+
+    // Pipelined mode runs each plugin of a serial chain on its own core, one
+    //  block behind the one before it. It holds whole blocks between stages,
+    //  so it expects the driver to deliver a constant block size. Where chains
+    //  of different lengths (or a chain and a plain branch) meet at a mixer,
+    //  the shorter ones are delayed to match, so both sides of the A/B switch
+    //  stay in time and the reported latency is the output's actual lag.
+    void setPipelined (bool shouldPipeline)             { pipelined = shouldPipeline; }
+    bool isPipelined() const                            { return pipelined; }
+    int getLatencySamples() const                       { return latencySamples.load(); }
+
+    // Runs the schedule on blocks of exactly this many samples whatever sizes
+    //  the driver delivers, re-blocking through a FIFO for one block of added
+    //  latency. Plugins are prepared for this size. 0 follows the device.
+    //  Takes effect at the next prepare().
+    void setFixedBlockSize (int numSamples)             { fixedBlockSize = juce::jmax (0, numSamples); }
+    int getFixedBlockSize() const                       { return fixedBlockSize; }
+
+    // Switching paths crossfades from the sample it happens on. Once the
+    //  unplayed path has faded out and its tails have died away, its plugins
+    //  stop being processed until it's selected again.
+    //
+    // Path, bypass and plugin changes go to the audio thread through a
+    //  bounded command queue and take effect together at the next block.
+    //  The getters report what the audio thread has applied.
+    void setActivePath (int path);
+    int getActivePath() const                           { return activePath.load(); }
+    void setSlotBypassed (int index, bool shouldBypass);
+    bool isSlotBypassed (int index) const;
+    void setSwitchCrossfadeSamples (int numSamples)     { switchFadeSamples.store (juce::jmax (1, numSamples)); }
+
+    // Levels at every node output of the running board, see MeterBank
+    MeterBank& getMeters()                              { return meters; }
+
+    // Times every block and every plugin while set. Pass nullptr to stop.
+    void setProfiler (AudioProfiler* newProfiler)       { profiler.store (newProfiler); }
+
+    // Live mode: one worker per core, each pinned to it and run SCHED_FIFO at
+    //  this priority. Takes effect at the next prepare().
+    void setWorkerCores (const juce::Array<int>& cores, int fifoPriority);
+    const RealtimeThreadPool* getWorkerPool() const     { return workerPool.get(); }
+
+    double getSampleRate() const                        { return currentSampleRate; }
+    int getMaxBlockSize() const                         { return currentBlockSize; }
+
+private:
+    struct BlockContext
+    {
+        SignalGraph* owner;
+        CompiledGraph* graph;
+        const GraphPhase* phase;
+        const float* const* inputChannelData;
+        int numInputChannels;
+        float* const* outputChannelData;
+        int numOutputChannels;
+        int offset;
+        int numSamples;
+        int parity;
+        juce::int64 streamStart;    // stream time of sample 0
+        AudioProfiler* profiler;
+    };
+
+    struct GraphCommand
+    {
+        enum class Kind : uint8_t { selectPath, setBypass, swapPlugin };
+
+        Kind kind;
+        SlotProcessor* slot;
+        juce::AudioPluginInstance* plugin;
+        int value;
+    };
+
+    struct PathSwitch
+    {
+        float fromGain = 0.0f;      // path B's gain when the fade started
+        int target = 0;
+        juce::int64 startTime = 0;
+        int fadeSamples = 1;
+    };
+
+    struct PendingMidi
+    {
+        juce::int64 time;           // in samples since the stream started
+        MidiEvent event;
+    };
+
+    std::unique_ptr<CompiledGraph> compile (juce::String& error) const;
+    void runBlocks (BlockContext& context, int numSamples);
+    void runReblocked (const BlockContext& context, int numSamples);
+    void runSchedule (BlockContext& context);
+    void runTask (const BlockContext& context, GraphTask& task);
+    void checkDeadline (SlotProcessor& slot, juce::int64 elapsedTicks, int numSamples);
+    void processSlot (SlotProcessor& slot, const GraphStep& step, CompiledGraph& graph, int input, int output,
+                      int scratch, juce::int64 blockStart, int numSamples);
+    bool hasMidiFor (int slotIndex, juce::int64 blockStart, int numSamples) const;
+    int getSleepAfterSamples (const juce::AudioPluginInstance* plugin) const;
+    bool post (const GraphCommand& command);
+    bool canPost() const                                { return commandFifo.getFreeSpace() > 0; }
+    void applyCommands();
+    void queueMidi (const MidiEvent* events, int numEvents);
+    void dropMidiBefore (juce::int64 time);
+    void meterBuffer (const CompiledGraph& graph, int node, int port, int buffer, int numSamples);
+    float getPathGain (int path, juce::int64 time) const;
+    void beginPathSwitch (int target, juce::int64 time);
+    void updatePathSleep (int numSamples);
+    void switchPaths (const CompiledGraph& graph, const GraphStep& step, juce::int64 blockStart, int numSamples) const;
+    static void runTaskInPool (void* context, int taskIndex);
+    static void preparePlugin (juce::AudioPluginInstance& plugin, double sampleRate, int blockSize);
+    void prepareIfStale (juce::AudioPluginInstance& plugin) const;
+    void requestSwap (BoardScene& scene, int index, std::unique_ptr<juce::AudioPluginInstance> instance);
+
+    std::vector<std::unique_ptr<BoardScene>> scenes;
+    int currentScene = 0;
+    std::atomic<const BoardScene*> runningScene { nullptr };  // written by the audio thread
+
+    double currentSampleRate = 44100.0;
+    int currentBlockSize = 256;
+    double crossfadeMs = 20.0;
+    std::atomic<int> crossfadeSamples { 882 };
+
+    bool pipelined = false;
+    int fixedBlockSize = 0;
+    int reblockSize = 0;            // fixedBlockSize as of the last prepare()
+    std::atomic<int> latencySamples { 0 };
+    std::atomic<int> activePath { 0 };
+    std::atomic<int> switchFadeSamples { 480 };
+    std::atomic<AudioProfiler*> profiler { nullptr };
+    MeterBank meters;
+
+    std::unique_ptr<RealtimeThreadPool> workerPool;
+    juce::Array<int> workerCores;
+    int workerPriority = 0;
+    bool workerConfigChanged = false;
+
+    // Audio thread only
+    static constexpr int maxPendingMidi = 512;
+    std::array<PendingMidi, maxPendingMidi> pendingMidi;
+    int numPendingMidi = 0;
+    juce::int64 streamPosition = 0;
+    PathSwitch pathSwitch;
+    std::array<bool, 2> pathAsleep { false, false };
+
+    // Anything under -80 dB counts as silence. A path's exits must stay
+    //  silent this long before it can sleep.
+    static constexpr float silenceThreshold = 1.0e-4f;
+    static constexpr double tailHoldSeconds = 0.25;
+    int tailHoldSamples = 11025;
+
+    // Watchdog: strikes before a bypass, and how long a clean run has to last
+    //  before earlier strikes are forgiven
+    static constexpr int watchdogStrikes = 3;
+    static constexpr double watchdogForgiveSeconds = 2.0;
+    std::atomic<double> watchdogBudget { 0.5 };
+    double ticksPerSample = 0.0;
+    int watchdogForgiveSamples = 88200;
+
+    // Plugin sleep waits out the reported tail, within these limits
+    static constexpr double minSleepHoldSeconds = 0.05;
+    static constexpr double maxSleepTailSeconds = 30.0;
+
+    // Message thread to audio thread. One writer, one reader.
+    static constexpr int commandQueueSize = 256;
+    juce::AbstractFifo commandFifo { commandQueueSize };
+    std::array<GraphCommand, commandQueueSize> commands;
+
+    std::atomic<CompiledGraph*> pendingGraph { nullptr };
+    CompiledGraph* activeGraph = nullptr;       // audio thread only
+    GarbageCollector garbage;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SignalGraph)
+};
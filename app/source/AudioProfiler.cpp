@@ -0,0 +1,270 @@
+// ****************************************************************************
+//     Filename: AudioProfiler.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Audio thread profiler module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "AudioProfiler.h"
+
+// ****************************************************************************
+AudioProfiler::AudioProfiler()
+    : juce::Thread ("Audio profiler"),
+      history ((size_t) historySeconds, std::vector<Histogram> ((size_t) maxNodes, Histogram {})) {
+
+    for (int i = 0; i < maxLanes; ++i)
+        lanes.add (new Lane());
+
+    windowStartMs = loadStartMs = juce::Time::getMillisecondCounter();
+    startThread (juce::Thread::Priority::low);
+}
+
+// ****************************************************************************
+AudioProfiler::~AudioProfiler() {
+
+    stopThread (1000);
+    stopTrace();
+}
+
+// ****************************************************************************
+void AudioProfiler::record (int lane, int node, juce::int64 start, juce::int64 end, int numSamples) {
+
+    if (! juce::isPositiveAndBelow (lane, maxLanes))
+        return;
+
+    auto& target = *lanes.getUnchecked (lane);
+    const auto scope = target.fifo.write (1);
+    if (scope.blockSize1 + scope.blockSize2 == 0) {
+        droppedEvents.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    target.events[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = { start, end, node, numSamples };
+}
+
+// ****************************************************************************
+void AudioProfiler::setNodeNames (const juce::StringArray& names) {
+
+    const juce::ScopedLock sl (lock);
+    nodeNames = names;
+}
+
+// ****************************************************************************
+AudioProfiler::Summary AudioProfiler::getSummary() const {
+
+    const juce::ScopedLock sl (lock);
+    auto result = summary;
+    result.droppedEvents = droppedEvents.load();
+    if (juce::isPositiveAndBelow (result.worstNode, nodeNames.size()))
+        result.worstNodeName = nodeNames[result.worstNode];
+    return result;
+}
+
+// ****************************************************************************
+bool AudioProfiler::startTrace (const juce::File& file) {
+
+    file.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream> (file);
+    if (stream->failedToOpen())
+        return false;
+
+    *stream << "{\"traceEvents\":[\n";
+
+    const juce::ScopedLock sl (lock);
+    trace = std::move (stream);
+    traceStartTicks = now();
+    firstTraceEvent = true;
+    laneNamed.fill (false);
+    return true;
+}
+
+// ****************************************************************************
+void AudioProfiler::stopTrace() {
+
+    const juce::ScopedLock sl (lock);
+    if (trace == nullptr)
+        return;
+
+    *trace << "\n]}\n";
+    trace = nullptr;
+}
+
+// ****************************************************************************
+bool AudioProfiler::isTracing() const {
+
+    const juce::ScopedLock sl (lock);
+    return trace != nullptr;
+}
+
+// ****************************************************************************
+int AudioProfiler::bucketFor (double microseconds) {
+
+    const auto octaves = std::log2 (juce::jmax (microseconds, minBucketUs) / minBucketUs);
+    return juce::jlimit (0, numBuckets - 1, (int) (octaves * bucketsPerOctave));
+}
+
+// ****************************************************************************
+double AudioProfiler::bucketUpperUs (int bucket) {
+
+    return minBucketUs * std::exp2 ((double) (bucket + 1) / bucketsPerOctave);
+}
+
+// ****************************************************************************
+void AudioProfiler::run() {
+
+    while (! threadShouldExit()) {
+        wait (drainIntervalMs);
+
+        {
+            // Held across the whole drain so the trace can't close under us
+            const juce::ScopedLock sl (lock);
+            for (int lane = 0; lane < maxLanes; ++lane)
+                drainLane (lane);
+        }
+
+        const auto nowMs = juce::Time::getMillisecondCounter();
+
+        if (nowMs - loadStartMs >= (juce::uint32) loadWindowMs) {
+            const juce::ScopedLock sl (lock);
+            summary.load = realSeconds > 0.0 ? busySeconds / realSeconds : 0.0;
+            summary.peakLoad = peakLoad;
+            busySeconds = realSeconds = peakLoad = 0.0;
+            loadStartMs = nowMs;
+        }
+
+        if (nowMs - windowStartMs >= 1000) {
+            rollWindows();
+            windowStartMs = nowMs;
+        }
+    }
+}
+
+// ****************************************************************************
+void AudioProfiler::drainLane (int lane) {
+
+    auto& source = *lanes.getUnchecked (lane);
+    const auto scope = source.fifo.read (source.fifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        handleEvent (lane, source.events[(size_t) (scope.startIndex1 + i)]);
+    for (int i = 0; i < scope.blockSize2; ++i)
+        handleEvent (lane, source.events[(size_t) (scope.startIndex2 + i)]);
+}
+
+// ****************************************************************************
+void AudioProfiler::handleEvent (int lane, const ProfileEvent& event) {
+
+    const auto seconds = (double) (event.end - event.start) / ticksPerSecond;
+
+    if (event.node == blockNode) {
+        const auto blockSeconds = event.numSamples / sampleRate.load();
+        busySeconds += seconds;
+        realSeconds += blockSeconds;
+        if (blockSeconds > 0.0)
+            peakLoad = juce::jmax (peakLoad, seconds / blockSeconds);
+    }
+    else if (juce::isPositiveAndBelow (event.node, maxNodes)) {
+        ++history[(size_t) currentWindow][(size_t) event.node][(size_t) bucketFor (seconds * 1.0e6)];
+    }
+
+    if (trace != nullptr)
+        writeTraceEvent (lane, event);
+}
+
+// ****************************************************************************
+void AudioProfiler::rollWindows() {
+
+    // The worst node is the one with the highest p99 over the whole history
+    int worstNode = -1;
+    double worstP99 = 0.0;
+
+    for (int node = 0; node < maxNodes; ++node) {
+        Histogram merged {};
+        juce::uint64 total = 0;
+        for (auto& window : history) {
+            for (int b = 0; b < numBuckets; ++b) {
+                merged[(size_t) b] += window[(size_t) node][(size_t) b];
+                total += window[(size_t) node][(size_t) b];
+            }
+        }
+
+        if (total == 0)
+            continue;
+
+        const auto rank = total - total / 100;
+        juce::uint64 seen = 0;
+        for (int b = 0; b < numBuckets; ++b) {
+            seen += merged[(size_t) b];
+            if (seen >= rank) {
+                if (bucketUpperUs (b) > worstP99) {
+                    worstP99 = bucketUpperUs (b);
+                    worstNode = node;
+                }
+                break;
+            }
+        }
+    }
+
+    {
+        const juce::ScopedLock sl (lock);
+        summary.worstNode = worstNode;
+        summary.worstNodeP99Us = worstP99;
+    }
+
+    currentWindow = (currentWindow + 1) % historySeconds;
+    for (auto& histogram : history[(size_t) currentWindow])
+        histogram.fill (0);
+}
+
+// ****************************************************************************
+void AudioProfiler::writeTraceEvent (int lane, const ProfileEvent& event) {
+
+    auto toUs = [this] (juce::int64 ticks) { return (double) (ticks - traceStartTicks) * 1.0e6 / ticksPerSecond; };
+
+    auto& out = *trace;
+
+    if (! laneNamed[(size_t) lane]) {
+        laneNamed[(size_t) lane] = true;
+        const auto laneName = lane == blockLane ? juce::String ("Audio callback") : "Task " + juce::String (lane - 1);
+        out << (firstTraceEvent ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << lane
+            << ",\"args\":{\"name\":\"" << laneName << "\"}}";
+        firstTraceEvent = false;
+    }
+
+    const auto name = event.node == blockNode ? juce::String ("Block")
+                    : nodeNames[event.node].isNotEmpty() ? nodeNames[event.node]
+                                                         : "Node " + juce::String (event.node);
+
+    out << (firstTraceEvent ? "" : ",\n")
+        << "{\"name\":" << juce::JSON::toString (name) << ",\"cat\":\"dsp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << lane
+        << ",\"ts\":" << juce::String (toUs (event.start), 3) << ",\"dur\":" << juce::String (toUs (event.end) - toUs (event.start), 3)
+        << ",\"args\":{\"samples\":" << event.numSamples << "}}";
+    firstTraceEvent = false;
+}
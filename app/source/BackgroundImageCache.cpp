@@ -0,0 +1,132 @@
+// ****************************************************************************
+//     Filename: BackgroundImageCache.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Scaled background image cache module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "BackgroundImageCache.h"
+
+// ****************************************************************************
+BackgroundImageCache::BackgroundImageCache (const void* imageData, int imageDataSize, std::function<void()> onImageReady)
+    : juce::Thread ("Background image"),
+      data (imageData),
+      dataSize (imageDataSize),
+      onReady (std::move (onImageReady)) {
+
+    // Decoding starts right away, the first paint usually asks for a size
+    //  before it's done
+    startThread (juce::Thread::Priority::low);
+}
+
+// ****************************************************************************
+BackgroundImageCache::~BackgroundImageCache() {
+
+    stopThread (2000);
+}
+
+// ****************************************************************************
+bool BackgroundImageCache::draw (juce::Graphics& g, juce::Rectangle<int> area) {
+
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto width = juce::roundToInt ((float) area.getWidth() * scale);
+    const auto height = juce::roundToInt ((float) area.getHeight() * scale);
+
+    {
+        const juce::ScopedLock sl (lock);
+        if (rendered.isValid()) {
+            // Converted once here, so the blits below never have to
+            shown = juce::NativeImageType().convert (rendered);
+            rendered = {};
+        }
+
+        if (width != requestedWidth || height != requestedHeight) {
+            requestedWidth = width;
+            requestedHeight = height;
+            notify();
+        }
+    }
+
+    if (! shown.isValid())
+        return false;
+
+    if (shown.getWidth() == width && shown.getHeight() == height) {
+        // One image pixel per device pixel, so this is a straight copy
+        g.drawImageTransformed (shown, juce::AffineTransform::scale (1.0f / scale)
+                                           .translated ((float) area.getX(), (float) area.getY()));
+    }
+    else {
+        // A new size is on its way, stretch the old one cheaply until then
+        g.setImageResamplingQuality (juce::Graphics::lowResamplingQuality);
+        g.drawImage (shown, area.toFloat());
+    }
+    return true;
+}
+
+// ****************************************************************************
+void BackgroundImageCache::run() {
+
+    // Software images can be drawn into from any thread
+    decoded = juce::SoftwareImageType().convert (juce::ImageFileFormat::loadFrom (data, (size_t) dataSize));
+    if (! decoded.isValid())
+        return;
+
+    while (! threadShouldExit()) {
+        int width, height;
+        {
+            const juce::ScopedLock sl (lock);
+            width = requestedWidth;
+            height = requestedHeight;
+        }
+
+        if (width <= 0 || height <= 0 || (width == renderedWidth && height == renderedHeight)) {
+            wait (-1);
+            continue;
+        }
+
+        auto image = renderScaled (decoded, width, height);
+        {
+            const juce::ScopedLock sl (lock);
+            rendered = image;
+            renderedWidth = width;
+            renderedHeight = height;
+        }
+        juce::MessageManager::callAsync (onReady);
+    }
+}
+
+// ****************************************************************************
+juce::Image BackgroundImageCache::renderScaled (const juce::Image& source, int width, int height) const {
+
+    juce::Image image (juce::Image::RGB, width, height, false, juce::SoftwareImageType());
+    juce::Graphics g (image);
+    g.setImageResamplingQuality (juce::Graphics::highResamplingQuality);
+    g.drawImage (source, juce::Rectangle<float> ((float) width, (float) height), juce::RectanglePlacement::fillDestination);
+    return image;
+}
@@ -0,0 +1,581 @@
+// ****************************************************************************
+//     Filename: BoardFile.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Binary board file module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "BoardFile.h"
+
+static constexpr int boardMagic = 0x4452424d;      // "MBRD"
+static constexpr int boardVersion = 1;
+static constexpr int headerSize = 64;
+static constexpr int maxPluginsPerScene = 1024;
+
+// ****************************************************************************
+static juce::uint64 hashOf (const void* data, size_t size) {
+
+    // FNV-1a, only used to spot chunks that didn't change
+    auto hash = (juce::uint64) 0xcbf29ce484222325ull;
+    auto* bytes = static_cast<const juce::uint8*> (data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// ****************************************************************************
+static std::unique_ptr<juce::XmlElement> topologyToXml (const BoardTopology& topology) {
+
+    auto xml = std::make_unique<juce::XmlElement> ("BOARD");
+
+    for (auto& node : topology.getNodes()) {
+        auto* element = xml->createNewChildElement ("NODE");
+        element->setAttribute ("kind", (int) node.kind);
+        element->setAttribute ("name", node.name);
+        element->setAttribute ("slot", node.slot);
+    }
+
+    for (auto& edge : topology.getEdges()) {
+        auto* element = xml->createNewChildElement ("EDGE");
+        element->setAttribute ("source", edge.source);
+        element->setAttribute ("port", edge.sourcePort);
+        element->setAttribute ("dest", edge.dest);
+    }
+    return xml;
+}
+
+// ****************************************************************************
+static BoardTopology topologyFromXml (const juce::XmlElement& xml) {
+
+    BoardTopology topology;
+
+    for (auto* element : xml.getChildWithTagNameIterator ("NODE"))
+        topology.addNode ((NodeKind) juce::jlimit ((int) NodeKind::input, (int) NodeKind::output, element->getIntAttribute ("kind")),
+                          element->getStringAttribute ("name"), element->getIntAttribute ("slot", -1));
+
+    for (auto* element : xml.getChildWithTagNameIterator ("EDGE"))
+        topology.connect (element->getIntAttribute ("source"), element->getIntAttribute ("dest"),
+                          element->getIntAttribute ("port"));
+    return topology;
+}
+
+// ****************************************************************************
+bool SlotRecipe::getState (juce::MemoryBlock& dest) const {
+
+    if (source != nullptr)
+        return source->readChunk (stateChunk, dest);
+
+    dest = state;
+    return true;
+}
+
+// ****************************************************************************
+void SlotRecipe::loadState() {
+
+    if (source == nullptr)
+        return;
+
+    juce::MemoryBlock data;
+    source->readChunk (stateChunk, data);
+    state = std::move (data);
+    source = nullptr;
+    stateChunk = -1;
+}
+
+// ****************************************************************************
+// How many readers have each board file mapped
+static juce::CriticalSection mappedLock;
+static std::map<juce::String, int> mappedFiles;
+
+// ****************************************************************************
+std::shared_ptr<BoardFileReader> BoardFileReader::open (const juce::File& file, juce::String& error) {
+
+    std::shared_ptr<BoardFileReader> reader (new BoardFileReader (file));
+    if (! reader->parse (error))
+        return nullptr;
+    return reader;
+}
+
+// ****************************************************************************
+BoardFileReader::~BoardFileReader() {
+
+    if (map == nullptr)
+        return;
+
+    map = nullptr;
+    const juce::ScopedLock sl (mappedLock);
+    if (--mappedFiles[file.getFullPathName()] <= 0)
+        mappedFiles.erase (file.getFullPathName());
+}
+
+// ****************************************************************************
+bool BoardFileReader::isMapped (const juce::File& boardFile) {
+
+    const juce::ScopedLock sl (mappedLock);
+    return mappedFiles.find (boardFile.getFullPathName()) != mappedFiles.end();
+}
+
+// ****************************************************************************
+bool BoardFileReader::parse (juce::String& error) {
+
+    map = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    {
+        const juce::ScopedLock sl (mappedLock);
+        ++mappedFiles[file.getFullPathName()];
+    }
+    auto* data = static_cast<const char*> (map->getData());
+    const auto fileSize = (juce::int64) map->getSize();
+
+    if (data == nullptr || fileSize < headerSize) {
+        error = "Not a MoodBoard file";
+        return false;
+    }
+
+    juce::MemoryInputStream header (data, headerSize, false);
+    if (header.readInt() != boardMagic) {
+        error = "Not a MoodBoard file";
+        return false;
+    }
+    if (header.readInt() > boardVersion) {
+        error = "Board was saved by a newer version of MoodBoard";
+        return false;
+    }
+
+    const auto indexOffset = header.readInt64();
+    const auto indexSize = header.readInt64();
+    if (indexOffset < headerSize || indexSize <= 0 || indexOffset + indexSize > fileSize) {
+        error = "Board index is damaged";
+        return false;
+    }
+
+    juce::MemoryInputStream index (data + indexOffset, (size_t) indexSize, false);
+
+    const auto numChunks = index.readInt();
+    if (numChunks < 0 || numChunks > indexSize / 24) {
+        error = "Board index is damaged";
+        return false;
+    }
+
+    for (int i = 0; i < numChunks; ++i) {
+        BoardChunk chunk;
+        chunk.offset = index.readInt64();
+        chunk.size = index.readInt64();
+        chunk.hash = (juce::uint64) index.readInt64();
+        if (chunk.offset < headerSize || chunk.size < 0 || chunk.offset + chunk.size > fileSize) {
+            error = "Board chunk table is damaged";
+            return false;
+        }
+        chunks.push_back (chunk);
+    }
+
+    auto isChunk = [numChunks] (int c) { return juce::isPositiveAndBelow (c, numChunks); };
+
+    const auto numScenes = index.readInt();
+    currentScene = index.readInt();
+    if (numScenes <= 0 || numScenes > indexSize) {
+        error = "Board has no scenes";
+        return false;
+    }
+
+    for (int s = 0; s < numScenes; ++s) {
+        SceneEntry scene;
+        scene.name = index.readString();
+        scene.topologyChunk = index.readInt();
+
+        const auto numPlugins = index.readInt();
+        if (! isChunk (scene.topologyChunk) || ! juce::isPositiveAndNotGreaterThan (numPlugins, maxPluginsPerScene)) {
+            error = "Board scene table is damaged";
+            return false;
+        }
+
+        for (int p = 0; p < numPlugins; ++p) {
+            PluginEntry plugin;
+            plugin.slot = index.readInt();
+            plugin.descriptionChunk = index.readInt();
+            plugin.stateChunk = index.readInt();
+            plugin.outOfProcess = (index.readInt() & 1) != 0;
+
+            if (plugin.slot < 0 || ! isChunk (plugin.descriptionChunk)
+                 || (plugin.stateChunk != -1 && ! isChunk (plugin.stateChunk))) {
+                error = "Board scene table is damaged";
+                return false;
+            }
+            scene.plugins.push_back (plugin);
+        }
+        scenes.push_back (std::move (scene));
+    }
+
+    currentScene = juce::jlimit (0, numScenes - 1, currentScene);
+    return true;
+}
+
+// ****************************************************************************
+bool BoardFileReader::readChunk (int index, juce::MemoryBlock& dest) const {
+
+    if (! juce::isPositiveAndBelow (index, (int) chunks.size()))
+        return false;
+
+    auto& chunk = chunks[(size_t) index];
+    dest.replaceAll (static_cast<const char*> (map->getData()) + chunk.offset, (size_t) chunk.size);
+    return true;
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::XmlElement> BoardFileReader::readXmlChunk (int index) const {
+
+    auto& chunk = chunks[(size_t) index];
+    return juce::parseXML (juce::String::fromUTF8 (static_cast<const char*> (map->getData()) + chunk.offset,
+                                                   (int) chunk.size));
+}
+
+// ****************************************************************************
+std::vector<SceneRecipe> BoardFileReader::createScenes() {
+
+    std::vector<SceneRecipe> result;
+    auto self = shared_from_this();
+
+    for (auto& entry : scenes) {
+        SceneRecipe scene;
+        scene.name = entry.name;
+        if (auto xml = readXmlChunk (entry.topologyChunk))
+            scene.topology = topologyFromXml (*xml);
+
+        for (auto& plugin : entry.plugins) {
+            SlotRecipe recipe;
+            auto xml = readXmlChunk (plugin.descriptionChunk);
+            if (xml == nullptr || ! recipe.description.loadFromXml (*xml))
+                continue;
+
+            recipe.slot = plugin.slot;
+            recipe.outOfProcess = plugin.outOfProcess;
+            if (plugin.stateChunk >= 0) {
+                recipe.source = self;
+                recipe.stateChunk = plugin.stateChunk;
+            }
+            scene.plugins.push_back (std::move (recipe));
+        }
+        result.push_back (std::move (scene));
+    }
+    return result;
+}
+
+// ****************************************************************************
+BoardFileWriter::BoardFileWriter()
+    : juce::Thread ("Board writer") {
+}
+
+// ****************************************************************************
+BoardFileWriter::~BoardFileWriter() {
+
+    // run() finishes a pending save before it honours the exit request
+    signalThreadShouldExit();
+    notify();
+    stopThread (10000);
+}
+
+// ****************************************************************************
+void BoardFileWriter::save (const juce::File& file, std::vector<SceneRecipe> scenes, int currentScene) {
+
+    {
+        const juce::ScopedLock sl (jobLock);
+        pendingJob = std::make_unique<Job>();
+        pendingJob->file = file;
+        pendingJob->scenes = std::move (scenes);
+        pendingJob->currentScene = currentScene;
+        busy = true;
+    }
+
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::background);
+    notify();
+}
+
+// ****************************************************************************
+void BoardFileWriter::run() {
+
+    for (;;) {
+        std::unique_ptr<Job> job;
+        {
+            const juce::ScopedLock sl (jobLock);
+            job = std::move (pendingJob);
+            if (job == nullptr)
+                busy = false;
+        }
+
+        if (job == nullptr) {
+            if (threadShouldExit())
+                return;
+            wait (-1);
+            continue;
+        }
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+        juce::String error;
+        if (write (*job, error)) {
+            juce::Logger::writeToLog ("Saved " + job->file.getFileName() + " in "
+                                      + juce::String (juce::roundToInt (juce::Time::getMillisecondCounterHiRes() - startTime)) + " ms");
+        }
+        else {
+            forgetKnownFile();
+            juce::Logger::writeToLog ("Board save failed: " + error);
+        }
+    }
+}
+
+// ****************************************************************************
+void BoardFileWriter::forgetKnownFile() {
+
+    knownFile = juce::File();
+    knownChunks.clear();
+    knownFileSize = 0;
+}
+
+// ****************************************************************************
+bool BoardFileWriter::write (const Job& job, juce::String& error) {
+
+    // Learn the layout of a board we didn't write ourselves, so saving over
+    //  it still only appends what changed
+    if (job.file != knownFile) {
+        forgetKnownFile();
+        knownFile = job.file;
+
+        juce::String ignored;
+        if (job.file.existsAsFile()) {
+            if (auto reader = BoardFileReader::open (job.file, ignored)) {
+                for (int i = 0; i < reader->getNumChunks(); ++i) {
+                    auto& chunk = reader->getChunk (i);
+                    knownChunks[{ chunk.hash, chunk.size }] = chunk;
+                }
+                knownFileSize = job.file.getSize();
+            }
+        }
+    }
+
+    // Gather every blob the board refers to, deduplicated by content
+    struct Blob
+    {
+        juce::uint64 hash = 0;
+        juce::int64 size = 0;
+        juce::MemoryBlock data;
+        const SlotRecipe* lazy = nullptr;       // data still sits in a board file
+        BoardChunk chunk;
+    };
+
+    std::vector<Blob> blobs;
+    std::map<std::pair<juce::uint64, juce::int64>, int> blobIndex;
+
+    auto addBlob = [&] (juce::uint64 hash, juce::int64 size, juce::MemoryBlock data, const SlotRecipe* lazy) {
+        auto found = blobIndex.find ({ hash, size });
+        if (found != blobIndex.end())
+            return found->second;
+
+        Blob blob;
+        blob.hash = hash;
+        blob.size = size;
+        blob.data = std::move (data);
+        blob.lazy = lazy;
+        blobs.push_back (std::move (blob));
+        return blobIndex[{ hash, size }] = (int) blobs.size() - 1;
+    };
+
+    auto addData = [&] (juce::MemoryBlock data) {
+        const auto hash = hashOf (data.getData(), data.getSize());
+        const auto size = (juce::int64) data.getSize();
+        return addBlob (hash, size, std::move (data), nullptr);
+    };
+
+    auto addXml = [&] (const juce::XmlElement& xml) {
+        auto text = xml.toString (juce::XmlElement::TextFormat().singleLine().withoutHeader());
+        return addData ({ text.toRawUTF8(), text.getNumBytesAsUTF8() });
+    };
+
+    struct PluginEntry
+    {
+        int slot, description, state, flags;
+    };
+
+    std::vector<int> topologies;
+    std::vector<std::vector<PluginEntry>> plugins;
+
+    for (auto& scene : job.scenes) {
+        topologies.push_back (addXml (*topologyToXml (scene.topology)));
+
+        plugins.emplace_back();
+        for (auto& recipe : scene.plugins) {
+            auto description = recipe.description.createXml();
+            if (description == nullptr)
+                continue;
+
+            int state;
+            if (recipe.source != nullptr) {
+                // Never read a state back out of a board just to hash it
+                auto& chunk = recipe.source->getChunk (recipe.stateChunk);
+                state = addBlob (chunk.hash, chunk.size, {}, &recipe);
+            }
+            else {
+                state = addData (recipe.state);
+            }
+
+            plugins.back().push_back ({ recipe.slot, addXml (*description), state, recipe.outOfProcess ? 1 : 0 });
+        }
+    }
+
+    auto blobData = [] (Blob& blob) -> const juce::MemoryBlock& {
+        if (blob.lazy != nullptr && blob.data.getSize() == 0)
+            blob.lazy->getState (blob.data);
+        return blob.data;
+    };
+
+    auto writeIndex = [&] (juce::FileOutputStream& out) {
+        juce::MemoryOutputStream index;
+        index.writeInt ((int) blobs.size());
+        for (auto& blob : blobs) {
+            index.writeInt64 (blob.chunk.offset);
+            index.writeInt64 (blob.chunk.size);
+            index.writeInt64 ((juce::int64) blob.chunk.hash);
+        }
+
+        index.writeInt ((int) job.scenes.size());
+        index.writeInt (job.currentScene);
+        for (size_t s = 0; s < job.scenes.size(); ++s) {
+            index.writeString (job.scenes[s].name);
+            index.writeInt (topologies[s]);
+            index.writeInt ((int) plugins[s].size());
+            for (auto& plugin : plugins[s]) {
+                index.writeInt (plugin.slot);
+                index.writeInt (plugin.description);
+                index.writeInt (plugin.state);
+                index.writeInt (plugin.flags);
+            }
+        }
+
+        const auto indexOffset = out.getPosition();
+        out.write (index.getData(), index.getDataSize());
+        out.flush();
+
+        // The header goes last, so a save that dies halfway leaves the
+        //  previous index in charge
+        juce::MemoryOutputStream header;
+        header.writeInt (boardMagic);
+        header.writeInt (boardVersion);
+        header.writeInt64 (indexOffset);
+        header.writeInt64 ((juce::int64) index.getDataSize());
+        header.writeRepeatedByte (0, (size_t) headerSize - header.getDataSize());
+
+        out.setPosition (0);
+        out.write (header.getData(), header.getDataSize());
+        out.flush();
+        return out.getStatus().wasOk();
+    };
+
+    // Boards load their states lazily out of the mapped file, and the caller
+    //  has to have pulled them in first (see SceneCache::releaseBoardFile()).
+    //  Linux doesn't mind, but Windows refuses to touch a mapped file.
+    if (BoardFileReader::isMapped (job.file)) {
+        jassertfalse;
+       #if JUCE_WINDOWS
+        error = job.file.getFileName() + " is still open for reading";
+        return false;
+       #endif
+    }
+
+    // Decide between appending and rewriting the whole file
+    juce::int64 liveBytes = headerSize;
+    juce::int64 appendBytes = 0;
+    for (auto& blob : blobs) {
+        liveBytes += blob.size;
+        if (knownChunks.find ({ blob.hash, blob.size }) == knownChunks.end())
+            appendBytes += blob.size;
+    }
+
+    const auto deadBytes = knownFileSize + appendBytes - liveBytes;
+    const bool rewrite = knownFileSize == 0 || (deadBytes > liveBytes && deadBytes > compactThreshold);
+
+    if (rewrite) {
+        juce::TemporaryFile temp (job.file);
+        {
+            juce::FileOutputStream out (temp.getFile());
+            if (! out.openedOk()) {
+                error = out.getStatus().getErrorMessage();
+                return false;
+            }
+
+            out.writeRepeatedByte (0, (size_t) headerSize);
+            for (auto& blob : blobs) {
+                auto& data = blobData (blob);
+                blob.chunk = { out.getPosition(), (juce::int64) data.getSize(), blob.hash };
+                out.write (data.getData(), data.getSize());
+            }
+
+            if (! writeIndex (out)) {
+                error = out.getStatus().getErrorMessage();
+                return false;
+            }
+        }
+
+        if (! temp.overwriteTargetFileWithTemporary()) {
+            error = "Unable to replace " + job.file.getFullPathName();
+            return false;
+        }
+    }
+    else {
+        // Opens at the end of the existing file
+        juce::FileOutputStream out (job.file);
+        if (! out.openedOk()) {
+            error = out.getStatus().getErrorMessage();
+            return false;
+        }
+
+        for (auto& blob : blobs) {
+            auto known = knownChunks.find ({ blob.hash, blob.size });
+            if (known != knownChunks.end()) {
+                blob.chunk = known->second;
+                continue;
+            }
+
+            auto& data = blobData (blob);
+            blob.chunk = { out.getPosition(), (juce::int64) data.getSize(), blob.hash };
+            out.write (data.getData(), data.getSize());
+        }
+
+        if (! writeIndex (out)) {
+            error = out.getStatus().getErrorMessage();
+            return false;
+        }
+    }
+
+    // The file now holds exactly the chunks of this index
+    knownChunks.clear();
+    for (auto& blob : blobs)
+        knownChunks[{ blob.hash, blob.size }] = blob.chunk;
+    knownFileSize = job.file.getSize();
+    return true;
+}
@@ -0,0 +1,345 @@
+// ****************************************************************************
+//     Filename: BufferSizeTuner.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Finds the smallest stable device buffer size
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "BufferSizeTuner.h"
+
+// ****************************************************************************
+BufferSizeTuner::BufferSizeTuner (juce::AudioDeviceManager& deviceManager, AudioProfiler& profiler,
+                                  const juce::File& settingsFile)
+    : manager (deviceManager),
+      audioProfiler (profiler),
+      file (settingsFile) {
+}
+
+// ****************************************************************************
+BufferSizeTuner::~BufferSizeTuner() {
+
+    stopTimer();
+}
+
+// ****************************************************************************
+juce::File BufferSizeTuner::getDefaultSettingsFile() {
+
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("MoodBoard")
+               .getChildFile ("BufferSizes.xml");
+}
+
+// ****************************************************************************
+void BufferSizeTuner::callbackStarted (int numSamples) noexcept {
+
+    const auto now = AudioProfiler::now();
+    const auto last = lastCallbackTicks.exchange (now, std::memory_order_relaxed);
+    const auto previousSamples = lastNumSamples.exchange (numSamples, std::memory_order_relaxed);
+    const auto perSample = ticksPerSample.load (std::memory_order_relaxed);
+    if (last == 0 || perSample <= 0.0)
+        return;
+
+    // How much later this callback came than the last block's length implies
+    const auto expected = (juce::int64) (perSample * previousSamples);
+    const auto lateness = now - last - expected;
+    if (lateness <= 0)
+        return;
+
+    auto worst = worstLatenessTicks.load (std::memory_order_relaxed);
+    while (lateness > worst && ! worstLatenessTicks.compare_exchange_weak (worst, lateness, std::memory_order_relaxed)) {
+    }
+
+    if (lateness > expected / 2)
+        lateCallbacks.fetch_add (1, std::memory_order_relaxed);
+}
+
+// ****************************************************************************
+void BufferSizeTuner::deviceStarted (double sampleRate) noexcept {
+
+    ticksPerSample.store ((double) juce::Time::getHighResolutionTicksPerSecond() / sampleRate, std::memory_order_relaxed);
+    lastCallbackTicks.store (0, std::memory_order_relaxed);
+}
+
+// ****************************************************************************
+bool BufferSizeTuner::start (const juce::String& boardKey, FinishedCallback onFinished) {
+
+    auto* device = manager.getCurrentAudioDevice();
+    if (device == nullptr || isTuning())
+        return false;
+
+    sizes = device->getAvailableBufferSizes();
+    sizes.sort();
+    if (sizes.isEmpty())
+        return false;
+
+    // Start from the size we're running at, or the nearest one the driver offers
+    originalSize = device->getCurrentBufferSizeSamples();
+    startIndex = 0;
+    for (int i = 0; i < sizes.size(); ++i)
+        if (std::abs (sizes[i] - originalSize) < std::abs (sizes[startIndex] - originalSize))
+            startIndex = i;
+
+    board = boardKey;
+    finished = std::move (onFinished);
+    trials.clearQuick();
+    current = startIndex;
+    direction = -1;
+    bestStable = -1;
+
+    juce::Logger::writeToLog ("Tuning buffer size on " + getDeviceKey());
+    startTimer (tickMs);
+    beginTrial();
+    return true;
+}
+
+// ****************************************************************************
+void BufferSizeTuner::cancel() {
+
+    if (! isTuning())
+        return;
+
+    stopTimer();
+    finished = nullptr;
+    setBufferSize (originalSize);
+}
+
+// ****************************************************************************
+juce::String BufferSizeTuner::getStatus() const {
+
+    if (! isTuning())
+        return {};
+
+    const auto elapsed = juce::Time::getMillisecondCounterHiRes() / 1000.0 - trialStart;
+    return "Tuning " + juce::String (sizes[current]) + " samples"
+           + (soaking ? " (" + juce::String (juce::roundToInt (elapsed)) + "/" + juce::String (juce::roundToInt (soakSeconds)) + " s)"
+                      : juce::String (" (settling)"));
+}
+
+// ****************************************************************************
+bool BufferSizeTuner::applySaved (const juce::String& boardKey) {
+
+    auto* device = manager.getCurrentAudioDevice();
+    const auto saved = loadSaved (boardKey);
+    if (device == nullptr || saved <= 0 || ! device->getAvailableBufferSizes().contains (saved))
+        return false;
+
+    if (device->getCurrentBufferSizeSamples() == saved)
+        return true;
+
+    juce::Logger::writeToLog ("Using the tuned buffer size of " + juce::String (saved) + " samples");
+    return setBufferSize (saved);
+}
+
+// ****************************************************************************
+void BufferSizeTuner::timerCallback() {
+
+    if (manager.getCurrentAudioDevice() == nullptr) {
+        cancel();
+        return;
+    }
+
+    const auto elapsed = juce::Time::getMillisecondCounterHiRes() / 1000.0 - trialStart;
+
+    // A device restart always glitches, so only start counting once it has settled
+    if (! soaking) {
+        if (elapsed < settleSeconds)
+            return;
+
+        soaking = true;
+        trialStart += elapsed;
+        worstLoad = 0.0;
+        worstLatenessTicks.store (0, std::memory_order_relaxed);
+        startLate = lateCallbacks.load (std::memory_order_relaxed);
+        startXRuns = manager.getCurrentAudioDevice()->getXRunCount();
+        return;
+    }
+
+    worstLoad = juce::jmax (worstLoad, audioProfiler.getSummary().peakLoad);
+
+    if (elapsed >= soakSeconds)
+        finishTrial();
+}
+
+// ****************************************************************************
+void BufferSizeTuner::beginTrial() {
+
+    trialStart = juce::Time::getMillisecondCounterHiRes() / 1000.0;
+    soaking = false;
+
+    if (! setBufferSize (sizes[current])) {
+        Trial failed;
+        failed.bufferSize = sizes[current];
+        evaluate (failed);
+    }
+}
+
+// ****************************************************************************
+void BufferSizeTuner::finishTrial() {
+
+    auto* device = manager.getCurrentAudioDevice();
+
+    Trial trial;
+    trial.bufferSize = sizes[current];
+    trial.peakLoad = worstLoad;
+
+    const auto periodTicks = ticksPerSample.load (std::memory_order_relaxed) * trial.bufferSize;
+    if (periodTicks > 0.0)
+        trial.jitter = (double) worstLatenessTicks.load (std::memory_order_relaxed) / periodTicks;
+
+    // Not every driver counts xruns, so fall back to callbacks that came late
+    //  by more than half a period
+    const auto xruns = device->getXRunCount();
+    if (startXRuns >= 0 && xruns >= 0)
+        trial.xruns = xruns - startXRuns;
+    else
+        trial.xruns = lateCallbacks.load (std::memory_order_relaxed) - startLate;
+
+    trial.stable = trial.xruns == 0 && trial.jitter + trial.peakLoad < headroom;
+
+    juce::Logger::writeToLog ("Buffer " + juce::String (trial.bufferSize).paddedLeft (' ', 5) + ": load "
+                              + juce::String (juce::roundToInt (trial.peakLoad * 100.0)) + "%, jitter "
+                              + juce::String (juce::roundToInt (trial.jitter * 100.0)) + "%, xruns "
+                              + juce::String (trial.xruns) + (trial.stable ? "" : "  unstable"));
+    evaluate (trial);
+}
+
+// ****************************************************************************
+void BufferSizeTuner::evaluate (const Trial& trial) {
+
+    trials.add (trial);
+    if (trial.stable)
+        bestStable = current;
+
+    // Going down, the first failure ends the search: smaller only gets worse
+    if (direction < 0) {
+        if (trial.stable && current > 0) {
+            --current;
+            beginTrial();
+        }
+        else if (bestStable >= 0) {
+            finish (sizes[bestStable]);
+        }
+        else if (startIndex + 1 < sizes.size()) {
+            direction = 1;
+            current = startIndex + 1;
+            beginTrial();
+        }
+        else {
+            finish (originalSize);
+        }
+        return;
+    }
+
+    // Going up, the first size that holds is the one
+    if (trial.stable)
+        finish (trial.bufferSize);
+    else if (current + 1 < sizes.size()) {
+        ++current;
+        beginTrial();
+    }
+    else
+        finish (originalSize);
+}
+
+// ****************************************************************************
+void BufferSizeTuner::finish (int bufferSize) {
+
+    stopTimer();
+    setBufferSize (bufferSize);
+
+    if (bestStable >= 0)
+        save (board, bufferSize);
+
+    juce::Logger::writeToLog ("Tuned buffer size: " + juce::String (bufferSize) + " samples");
+    if (auto callback = std::move (finished))
+        callback (bufferSize, trials);
+}
+
+// ****************************************************************************
+bool BufferSizeTuner::setBufferSize (int bufferSize) {
+
+    auto setup = manager.getAudioDeviceSetup();
+    if (setup.bufferSize == bufferSize && manager.getCurrentAudioDevice() != nullptr)
+        return true;
+
+    setup.bufferSize = bufferSize;
+    auto error = manager.setAudioDeviceSetup (setup, true);
+    if (error.isNotEmpty()) {
+        juce::Logger::writeToLog ("Unable to set a buffer size of " + juce::String (bufferSize) + ": " + error);
+        return false;
+    }
+    return true;
+}
+
+// ****************************************************************************
+juce::String BufferSizeTuner::getDeviceKey() const {
+
+    if (auto* device = manager.getCurrentAudioDevice())
+        return device->getTypeName() + "/" + device->getName();
+    return {};
+}
+
+// ****************************************************************************
+int BufferSizeTuner::loadSaved (const juce::String& boardKey) const {
+
+    auto xml = juce::parseXML (file);
+    if (xml == nullptr || ! xml->hasTagName ("BUFFERSIZES"))
+        return 0;
+
+    const auto deviceKey = getDeviceKey();
+    for (auto* entry : xml->getChildWithTagNameIterator ("BOARD"))
+        if (entry->getStringAttribute ("board") == boardKey && entry->getStringAttribute ("device") == deviceKey)
+            return entry->getIntAttribute ("bufferSize");
+    return 0;
+}
+
+// ****************************************************************************
+void BufferSizeTuner::save (const juce::String& boardKey, int bufferSize) const {
+
+    auto xml = juce::parseXML (file);
+    if (xml == nullptr || ! xml->hasTagName ("BUFFERSIZES"))
+        xml = std::make_unique<juce::XmlElement> ("BUFFERSIZES");
+
+    const auto deviceKey = getDeviceKey();
+    juce::XmlElement* found = nullptr;
+    for (auto* entry : xml->getChildWithTagNameIterator ("BOARD"))
+        if (entry->getStringAttribute ("board") == boardKey && entry->getStringAttribute ("device") == deviceKey)
+            found = entry;
+
+    if (found == nullptr) {
+        found = xml->createNewChildElement ("BOARD");
+        found->setAttribute ("board", boardKey);
+        found->setAttribute ("device", deviceKey);
+    }
+    found->setAttribute ("bufferSize", bufferSize);
+
+    file.getParentDirectory().createDirectory();
+    if (! xml->writeTo (file))
+        DBG ("Unable to write buffer sizes " << file.getFullPathName());
+}
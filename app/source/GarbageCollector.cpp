@@ -0,0 +1,85 @@
+// ****************************************************************************
+//     Filename: GarbageCollector.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Frees objects retired by the audio thread
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "GarbageCollector.h"
+
+// ****************************************************************************
+GarbageCollector::GarbageCollector() : juce::Thread ("Garbage collector") {
+
+    startThread (juce::Thread::Priority::low);
+}
+
+// ****************************************************************************
+GarbageCollector::~GarbageCollector() {
+
+    stopThread (1000);
+
+    // Whoever retired the rest has stopped by now
+    collect();
+}
+
+// ****************************************************************************
+void GarbageCollector::run() {
+
+    while (! threadShouldExit()) {
+        collect();
+        wait (pollIntervalMs);
+    }
+}
+
+// ****************************************************************************
+bool GarbageCollector::push (const Item& item) {
+
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 > 0)
+        queue[(size_t) scope.startIndex1] = item;
+    else if (scope.blockSize2 > 0)
+        queue[(size_t) scope.startIndex2] = item;
+    else
+        return false;
+    return true;
+}
+
+// ****************************************************************************
+void GarbageCollector::collect() {
+
+    const auto scope = fifo.read (fifo.getNumReady());
+
+    auto destroy = [this] (int start, int count) {
+        for (int i = start; i < start + count; ++i)
+            queue[(size_t) i].destroy (queue[(size_t) i].object);
+    };
+
+    destroy (scope.startIndex1, scope.blockSize1);
+    destroy (scope.startIndex2, scope.blockSize2);
+}
@@ -0,0 +1,159 @@
+// ****************************************************************************
+//     Filename: LiveMode.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Real-time setup for dedicated Linux machines
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "LiveMode.h"
+#include "RealtimeThreadPool.h"
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+ #include <sys/resource.h>
+ #include <cerrno>
+ #include <cstring>
+#endif
+
+// ****************************************************************************
+LiveMode::LiveMode (bool shouldEnable) : enabled (shouldEnable) {
+
+    if (! enabled)
+        return;
+
+    cores = getIsolatedCores();
+
+   #if JUCE_LINUX
+    int flags = MCL_CURRENT | MCL_FUTURE;
+   #ifdef MCL_ONFAULT
+    flags |= MCL_ONFAULT;
+   #endif
+    memoryLocked = mlockall (flags) == 0;
+    if (! memoryLocked)
+        memoryError = std::strerror (errno);
+   #else
+    memoryError = "only supported on Linux";
+   #endif
+}
+
+// ****************************************************************************
+juce::Array<int> LiveMode::getIsolatedCores() {
+
+    // The kernel lists them as ranges, e.g. "2-3,6"
+    juce::Array<int> result;
+    const auto list = juce::File ("/sys/devices/system/cpu/isolated").loadFileAsString().trim();
+
+    for (auto& range : juce::StringArray::fromTokens (list, ",", "")) {
+        const auto first = range.upToFirstOccurrenceOf ("-", false, false).getIntValue();
+        const auto last = range.contains ("-") ? range.fromFirstOccurrenceOf ("-", false, false).getIntValue() : first;
+        for (int core = first; core <= last; ++core)
+            result.add (core);
+    }
+    return result;
+}
+
+// ****************************************************************************
+juce::Array<int> LiveMode::getWorkerCores() const {
+
+    juce::Array<int> workers;
+    for (int i = 1; i < cores.size(); ++i)
+        workers.add (cores[i]);
+    return workers;
+}
+
+// ****************************************************************************
+void LiveMode::setUpAudioThread() {
+
+    if (! audioSetupPending.load (std::memory_order_relaxed))
+        return;
+    audioSetupPending.store (false, std::memory_order_relaxed);
+
+    // The device thread may be a new one after every restart
+    audioFifo.store (RealtimeThreadPool::setCurrentThreadFifo (audioPriority));
+    audioPinned.store (getAudioCore() >= 0 && RealtimeThreadPool::pinCurrentThread (getAudioCore()));
+    audioDenormalsOff.store (juce::FloatVectorOperations::areDenormalsDisabled());
+    RealtimeThreadPool::prefaultStack();
+
+    reportReady.store (true, std::memory_order_release);
+}
+
+// ****************************************************************************
+bool LiveMode::takeReport (juce::String& report, const RealtimeThreadPool* workers) {
+
+    if (! reportReady.exchange (false, std::memory_order_acquire))
+        return false;
+
+    report = getReport (workers);
+    return true;
+}
+
+// ****************************************************************************
+juce::String LiveMode::getReport (const RealtimeThreadPool* workers) const {
+
+    if (! enabled)
+        return "Live mode is off, start with --live to enable it";
+
+    auto yesNo = [] (bool b) { return juce::String (b ? "yes" : "NO"); };
+
+    juce::String report ("Live mode\n");
+
+    report << "  Memory locked: " << yesNo (memoryLocked);
+    if (! memoryLocked)
+        report << " (" << memoryError << ", raise memlock in /etc/security/limits.conf)";
+   #if JUCE_LINUX
+    rlimit limit {};
+    if (memoryLocked && getrlimit (RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        report << " (limit " << juce::File::descriptionOfSizeInBytes ((juce::int64) limit.rlim_cur)
+               << ", allocations past it will fail)";
+   #endif
+    report << "\n";
+
+    report << "  Isolated cores: ";
+    if (cores.isEmpty()) {
+        report << "none (boot with isolcpus=, threads are not pinned)\n";
+    }
+    else {
+        juce::StringArray names;
+        for (auto core : cores)
+            names.add (juce::String (core));
+        report << names.joinIntoString (", ") << "\n";
+    }
+
+    report << "  Audio thread: SCHED_FIFO " << audioPriority << " " << yesNo (audioFifo.load())
+           << ", pinned " << (getAudioCore() >= 0 ? yesNo (audioPinned.load()) : juce::String ("n/a"))
+           << ", denormals flushed " << yesNo (audioDenormalsOff.load()) << "\n";
+
+    if (workers != nullptr) {
+        const auto numWorkers = workers->getNumWorkers();
+        report << "  Workers: " << workers->getNumFifoWorkers() << " of " << numWorkers
+               << " SCHED_FIFO " << workerPriority << ", " << workers->getNumPinnedWorkers() << " pinned\n";
+    }
+
+    return report;
+}
@@ -0,0 +1,173 @@
+// ****************************************************************************
+//     Filename: LoopArena.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Preallocated loop storage module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "LoopArena.h"
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+#endif
+
+// ****************************************************************************
+LoopArena::LoopArena (int ramPages, int spillPages)
+    : numRamPages (ramPages),
+      numSpillPages (spillPages),
+      releasedFifo (spillPages + 1) {
+
+    // Writing every page now makes it resident before the audio thread needs it
+    ram.malloc ((size_t) numRamPages * pageSize);
+    juce::FloatVectorOperations::clear (ram.get(), numRamPages * pageSize);
+
+    if (numSpillPages > 0) {
+        // Kept off the temp directory, which is often tmpfs and so just RAM again
+        const auto folder = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                                .getChildFile ("MoodBoard")
+                                .getChildFile ("LoopSpill");
+        folder.createDirectory();
+        spillFile = folder.getNonexistentChildFile ("MoodBoardLoop", ".spill");
+
+        // Extending the file by seeking leaves it sparse until pages get used
+        const auto bytes = (juce::int64) numSpillPages * pageSize * (juce::int64) sizeof (float);
+        {
+            juce::FileOutputStream out (spillFile);
+            if (out.openedOk()) {
+                out.setPosition (bytes - 1);
+                out.writeByte (0);
+            }
+        }
+
+        spill = std::make_unique<juce::MemoryMappedFile> (spillFile, juce::MemoryMappedFile::readWrite);
+        if (spill->getData() == nullptr || (juce::int64) spill->getSize() < bytes) {
+            DBG ("Unable to map loop spill file, loops are limited to RAM");
+            spill = nullptr;
+            numSpillPages = 0;
+        }
+
+       #if JUCE_LINUX
+        // Live mode locks our memory, but this tier is meant to leave RAM
+        if (spill != nullptr)
+            munlock (spill->getData(), spill->getSize());
+       #endif
+    }
+
+    // Popped from the back, so low pages go first
+    freeRam.reserve ((size_t) numRamPages);
+    for (int p = numRamPages; --p >= 0;)
+        freeRam.push_back (p);
+
+    // Nothing is ready yet; the preparing thread zeroes these first
+    ready.resize ((size_t) numReadyPages + 1);
+    released.resize ((size_t) spillPages + 1);
+    unprepared.reserve ((size_t) numSpillPages);
+    for (int p = numSpillPages; --p >= 0;)
+        unprepared.push_back (numRamPages + p);
+}
+
+// ****************************************************************************
+LoopArena::~LoopArena() {
+
+    spill = nullptr;
+    if (spillFile != juce::File())
+        spillFile.deleteFile();
+}
+
+// ****************************************************************************
+int LoopArena::allocate() {
+
+    if (freeRam.empty())
+        return pop (readyFifo, ready);
+
+    const auto page = freeRam.back();
+    freeRam.pop_back();
+    return page;
+}
+
+// ****************************************************************************
+void LoopArena::release (int page) {
+
+    // Capacity was reserved for every page, so neither of these can fail
+    if (isSpilled (page))
+        push (releasedFifo, released, page);
+    else
+        freeRam.push_back (page);
+}
+
+// ****************************************************************************
+void LoopArena::prepareSpillPages() {
+
+    if (spill == nullptr)
+        return;
+
+    for (int page; (page = pop (releasedFifo, released)) >= 0;)
+        unprepared.push_back (page);
+
+    // Zeroing faults the page in and makes the filesystem back it with real
+    //  blocks, so the recorder only ever writes to memory that's already there
+    while (! unprepared.empty() && readyFifo.getFreeSpace() > 0) {
+        const auto page = unprepared.back();
+        juce::FloatVectorOperations::clear (getPage (page), pageSize);
+        unprepared.pop_back();
+        push (readyFifo, ready, page);
+    }
+}
+
+// ****************************************************************************
+bool LoopArena::push (juce::AbstractFifo& fifo, std::vector<int>& queue, int page) {
+
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 > 0)
+        queue[(size_t) scope.startIndex1] = page;
+    else if (scope.blockSize2 > 0)
+        queue[(size_t) scope.startIndex2] = page;
+    else
+        return false;
+    return true;
+}
+
+// ****************************************************************************
+int LoopArena::pop (juce::AbstractFifo& fifo, std::vector<int>& queue) {
+
+    const auto scope = fifo.read (1);
+    if (scope.blockSize1 > 0)
+        return queue[(size_t) scope.startIndex1];
+    if (scope.blockSize2 > 0)
+        return queue[(size_t) scope.startIndex2];
+    return -1;
+}
+
+// ****************************************************************************
+float* LoopArena::getPage (int page) const {
+
+    if (isSpilled (page))
+        return static_cast<float*> (spill->getData()) + (size_t) (page - numRamPages) * pageSize;
+    return ram.get() + (size_t) page * pageSize;
+}
@@ -0,0 +1,485 @@
+// ****************************************************************************
+//     Filename: Looper.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Built-in looper module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "Looper.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/mman.h>
+#endif
+
+// ****************************************************************************
+// Splits a run of samples at page boundaries and at the end of the loop.
+//   fn (slot, offsetInPage, offsetInBlock, numSamples)
+
+template <typename Fn>
+static void forEachSpan (juce::int64 position, juce::int64 length, int numSamples, Fn&& fn) {
+
+    int done = 0;
+    while (done < numSamples) {
+        const auto offset = (int) (position % LoopArena::pageSize);
+        const auto span = (int) juce::jmin ((juce::int64) (numSamples - done),
+                                            (juce::int64) (LoopArena::pageSize - offset),
+                                            length - position);
+        fn ((int) (position / LoopArena::pageSize), offset, done, span);
+
+        done += span;
+        position += span;
+        if (position >= length)
+            position = 0;
+    }
+}
+
+// ****************************************************************************
+// Pulls spilled pages back in from disk a page ahead of the playhead, so the
+//   audio thread reads them from RAM, and zeroes fresh spill pages ahead of
+//   the record head so it never waits on the filesystem to write.
+
+class LooperProcessor::SpillPrefetcher final : public juce::Thread
+{
+public:
+    explicit SpillPrefetcher (LooperProcessor& owner)
+        : juce::Thread ("Loop prefetch"),
+          looper (owner) {
+    }
+
+    ~SpillPrefetcher() override {
+
+        stopThread (1000);
+    }
+
+    void run() override {
+
+        constexpr size_t pageBytes = LoopArena::pageSize * sizeof (float);
+
+        while (! threadShouldExit()) {
+            looper.arena.prepareSpillPages();
+
+            for (auto& entry : looper.lookahead) {
+                auto* page = entry.load (std::memory_order_relaxed);
+                if (page == nullptr)
+                    continue;
+
+               #if JUCE_LINUX || JUCE_MAC
+                madvise (page, pageBytes, MADV_WILLNEED);
+               #else
+                // Touch one float per VM page to fault it in
+                for (size_t i = 0; i < pageBytes / sizeof (float); i += 1024)
+                    juce::ignoreUnused (static_cast<volatile float*> (page)[i]);
+               #endif
+            }
+            wait (20);
+        }
+    }
+
+private:
+    LooperProcessor& looper;
+};
+
+// ****************************************************************************
+static int pagesFor (double seconds) {
+
+    // Sized for stereo at 48 kHz, so storage doesn't depend on the device
+    return juce::jmax (1, (int) std::ceil (seconds * 48000.0 * 2.0 / LoopArena::pageSize));
+}
+
+// ****************************************************************************
+LooperProcessor::LooperProcessor (double ramSeconds, double spillSeconds)
+    : AudioPluginInstance (BusesProperties().withInput  ("Input",  juce::AudioChannelSet::stereo())
+                                            .withOutput ("Output", juce::AudioChannelSet::stereo())),
+      arena (pagesFor (ramSeconds), spillSeconds > 0.0 ? pagesFor (spillSeconds) : 0) {
+
+    // A single layer may use every page of one channel
+    maxPagesPerLayer = arena.getNumPages();
+    for (auto& layer : layers) {
+        for (auto& channelPages : layer.pages)
+            channelPages.assign ((size_t) maxPagesPerLayer, -1);
+        layer.used.reserve ((size_t) (maxPagesPerLayer * numChannels));
+    }
+
+    if (arena.getNumPages() > pagesFor (ramSeconds)) {
+        prefetcher = std::make_unique<SpillPrefetcher> (*this);
+        prefetcher->startThread (juce::Thread::Priority::high);
+    }
+}
+
+// ****************************************************************************
+LooperProcessor::~LooperProcessor() {
+
+    prefetcher = nullptr;
+}
+
+// ****************************************************************************
+juce::PluginDescription LooperProcessor::getDescription() {
+
+    juce::PluginDescription d;
+    d.name = "MoodBoard Looper";
+    d.manufacturerName = "MoodBoard";
+    d.pluginFormatName = "Internal";
+    d.fileOrIdentifier = identifier;
+    d.numInputChannels = 2;
+    d.numOutputChannels = 2;
+    return d;
+}
+
+// ****************************************************************************
+void LooperProcessor::prepareToPlay (double, int maximumExpectedSamplesPerBlock) {
+
+    // Loops survive a re-prepare, only the mix scratch is resized
+    mixBuffer.setSize (numChannels, maximumExpectedSamplesPerBlock);
+}
+
+// ****************************************************************************
+void LooperProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+
+    juce::ScopedNoDenormals noDenormals;
+    const int numSamples = juce::jmin (buffer.getNumSamples(), mixBuffer.getNumSamples());
+
+    const auto command = (Command) pendingCommand.exchange ((int) Command::none);
+    if (command != Command::none)
+        handleCommand (command);
+
+    switch (state) {
+        case State::recording:
+            record (buffer, numSamples);
+        break;
+
+        case State::multiplying:
+            // The multiply layer stays open-ended until it is closed, which
+            //  only runs out when storage does
+            if (playhead + numSamples > loopLength)
+                endOverdub();
+            [[fallthrough]];
+
+        case State::playing:
+        case State::overdubbing:
+            play (numSamples);
+            if (state == State::overdubbing || state == State::multiplying)
+                overdub (buffer, numSamples);
+
+            for (int ch = 0; ch < juce::jmin (numChannels, buffer.getNumChannels()); ++ch)
+                buffer.addFrom (ch, 0, mixBuffer, ch, 0, numSamples);
+
+            playhead = (playhead + numSamples) % loopLength;
+        break;
+
+        case State::empty:
+        case State::stopped:
+        break;
+    }
+
+    publishLookahead();
+    publishedState.store ((int) state, std::memory_order_relaxed);
+    publishedLayers.store (numLayers, std::memory_order_relaxed);
+}
+
+// ****************************************************************************
+void LooperProcessor::handleCommand (Command command) {
+
+    switch (command) {
+        case Command::record:
+            if (state == State::empty) {
+                if (startLayer()) {
+                    playhead = 0;
+                    state = State::recording;
+                }
+            }
+            else if (state == State::recording) {
+                finishRecording();
+            }
+            else if (state == State::overdubbing || state == State::multiplying) {
+                endOverdub();
+            }
+            else {
+                handleCommand (Command::overdub);
+            }
+        break;
+
+        case Command::overdub:
+            if (state == State::recording)
+                finishRecording();
+
+            if (state == State::overdubbing || state == State::multiplying) {
+                endOverdub();
+            }
+            else if (state == State::playing || state == State::stopped) {
+                // With the layer stack full, overdubs merge into the top layer
+                startLayer();
+                state = State::overdubbing;
+            }
+        break;
+
+        case Command::multiply:
+            if (state == State::multiplying) {
+                endOverdub();
+            }
+            else if (state == State::playing || state == State::overdubbing) {
+                if (state == State::overdubbing)
+                    endOverdub();
+                if (startLayer()) {
+                    cycleLength = loopLength;
+                    loopLength = (juce::int64) maxPagesPerLayer * LoopArena::pageSize;
+                    layers[(size_t) (numLayers - 1)].length = loopLength;
+                    state = State::multiplying;
+                }
+            }
+        break;
+
+        case Command::undo:
+            if (state == State::overdubbing || state == State::multiplying)
+                endOverdub();
+
+            // The base layer only goes with a clear
+            if ((state == State::playing || state == State::stopped) && numLayers > 1) {
+                --numLayers;
+                ++numRedoLayers;
+                selectTopLayer();
+            }
+        break;
+
+        case Command::redo:
+            if ((state == State::playing || state == State::stopped) && numRedoLayers > 0) {
+                ++numLayers;
+                --numRedoLayers;
+                selectTopLayer();
+            }
+        break;
+
+        case Command::togglePlay:
+            if (state == State::recording)
+                finishRecording();
+            if (state == State::overdubbing || state == State::multiplying)
+                endOverdub();
+
+            if (state == State::playing) {
+                state = State::stopped;
+            }
+            else if (state == State::stopped) {
+                playhead = 0;
+                state = State::playing;
+            }
+        break;
+
+        case Command::clear:
+            clearAll();
+        break;
+
+        case Command::none:
+        break;
+    }
+}
+
+// ****************************************************************************
+bool LooperProcessor::startLayer() {
+
+    discardRedo();
+    if (numLayers == maxLayers)
+        return false;
+
+    auto& layer = layers[(size_t) numLayers++];
+    layer.length = loopLength;
+    return true;
+}
+
+// ****************************************************************************
+void LooperProcessor::releaseLayer (Layer& layer) {
+
+    // Only walks pages actually held, and only touches integers
+    for (auto code : layer.used) {
+        auto& page = layer.pages[(size_t) (code % numChannels)][(size_t) (code / numChannels)];
+        arena.release (page);
+        page = -1;
+    }
+    layer.used.clear();
+    layer.length = 0;
+}
+
+// ****************************************************************************
+void LooperProcessor::discardRedo() {
+
+    for (int i = numLayers; i < numLayers + numRedoLayers; ++i)
+        releaseLayer (layers[(size_t) i]);
+    numRedoLayers = 0;
+}
+
+// ****************************************************************************
+void LooperProcessor::clearAll() {
+
+    numRedoLayers += numLayers;
+    numLayers = 0;
+    discardRedo();
+
+    state = State::empty;
+    playhead = loopLength = cycleLength = 0;
+}
+
+// ****************************************************************************
+void LooperProcessor::finishRecording() {
+
+    auto& base = layers[0];
+    if (base.length < minLoopLength) {
+        clearAll();
+        return;
+    }
+
+    loopLength = cycleLength = base.length;
+    playhead = 0;
+    state = State::playing;
+}
+
+// ****************************************************************************
+void LooperProcessor::endOverdub() {
+
+    if (state == State::multiplying) {
+        // Round the multiplied loop up to a whole number of cycles
+        auto& layer = layers[(size_t) (numLayers - 1)];
+        const auto cycles = juce::jmax ((juce::int64) 1, (playhead + cycleLength - 1) / cycleLength);
+        layer.length = juce::jmin (cycles * cycleLength, layer.length);
+        loopLength = layer.length;
+        playhead %= loopLength;
+    }
+
+    state = State::playing;
+}
+
+// ****************************************************************************
+void LooperProcessor::selectTopLayer() {
+
+    loopLength = layers[(size_t) (numLayers - 1)].length;
+    playhead %= loopLength;
+}
+
+// ****************************************************************************
+float* LooperProcessor::pageFor (Layer& layer, int channel, int slot) {
+
+    auto& page = layer.pages[(size_t) channel][(size_t) slot];
+    if (page < 0) {
+        page = arena.allocate();
+        if (page < 0)
+            return nullptr;
+
+        // Spill pages arrive already zeroed from the prefetch thread
+        if (! arena.isSpilled (page))
+            juce::FloatVectorOperations::clear (arena.getPage (page), LoopArena::pageSize);
+        layer.used.push_back (slot * numChannels + channel);
+    }
+    return arena.getPage (page);
+}
+
+// ****************************************************************************
+void LooperProcessor::record (const juce::AudioBuffer<float>& input, int numSamples) {
+
+    auto& base = layers[0];
+    const auto capacity = (juce::int64) maxPagesPerLayer * LoopArena::pageSize;
+    const auto todo = (int) juce::jmin ((juce::int64) numSamples, capacity - base.length);
+    const auto channels = juce::jmin (numChannels, input.getNumChannels());
+    int written = 0;
+
+    // A span only counts once every channel has a page for it, so the loop
+    //  never grows past audio that was actually stored
+    forEachSpan (base.length, capacity, todo, [&] (int slot, int offset, int start, int span) {
+        if (written < start)
+            return;
+
+        std::array<float*, numChannels> pages {};
+        for (int ch = 0; ch < channels; ++ch)
+            if ((pages[(size_t) ch] = pageFor (base, ch, slot)) == nullptr)
+                return;
+
+        for (int ch = 0; ch < channels; ++ch)
+            juce::FloatVectorOperations::copy (pages[(size_t) ch] + offset, input.getReadPointer (ch, start), span);
+        written = start + span;
+    });
+
+    base.length += written;
+
+    // Out of storage, so the loop ends here
+    if (written < numSamples)
+        finishRecording();
+}
+
+// ****************************************************************************
+void LooperProcessor::overdub (const juce::AudioBuffer<float>& input, int numSamples) {
+
+    auto& layer = layers[(size_t) (numLayers - 1)];
+    bool full = false;
+
+    forEachSpan (playhead % layer.length, layer.length, numSamples, [&] (int slot, int offset, int start, int span) {
+        for (int ch = 0; ch < juce::jmin (numChannels, input.getNumChannels()); ++ch) {
+            if (auto* page = pageFor (layer, ch, slot))
+                juce::FloatVectorOperations::add (page + offset, input.getReadPointer (ch, start), span);
+            else
+                full = true;
+        }
+    });
+
+    if (full)
+        endOverdub();
+}
+
+// ****************************************************************************
+void LooperProcessor::play (int numSamples) {
+
+    mixBuffer.clear (0, numSamples);
+
+    for (int i = 0; i < numLayers; ++i) {
+        auto& layer = layers[(size_t) i];
+        forEachSpan (playhead % layer.length, layer.length, numSamples, [&] (int slot, int offset, int start, int span) {
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const auto page = layer.pages[(size_t) ch][(size_t) slot];
+                if (page >= 0)
+                    juce::FloatVectorOperations::add (mixBuffer.getWritePointer (ch, start),
+                                                      arena.getPage (page) + offset, span);
+            }
+        });
+    }
+}
+
+// ****************************************************************************
+void LooperProcessor::publishLookahead() {
+
+    for (int i = 0; i < maxLayers; ++i) {
+        auto& layer = layers[(size_t) i];
+        const bool active = i < numLayers && layer.length > 0 && state != State::recording;
+        const auto slot = active ? (int) (((playhead + LoopArena::pageSize) % layer.length) / LoopArena::pageSize) : 0;
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            float* next = nullptr;
+            if (active) {
+                const auto page = layer.pages[(size_t) ch][(size_t) slot];
+                if (page >= 0 && arena.isSpilled (page))
+                    next = arena.getPage (page);
+            }
+            lookahead[(size_t) (i * numChannels + ch)].store (next, std::memory_order_relaxed);
+        }
+    }
+}
@@ -1,4 +1,6 @@
 #include "MainComponent.h"
+#include "PluginSandbox.h"
+#include "OfflineRenderer.h"
 
 //==============================================================================
 class GuiAppApplication final : public juce::JUCEApplication
@@ -18,9 +20,34 @@ public:
     void initialise (const juce::String& commandLine) override
     {
         // This method is where you should put your application's initialisation code..
-        juce::ignoreUnused (commandLine);
 
-        mainWindow.reset (new MainWindow (getApplicationName()));
+        // When we've been launched as a plugin sandbox there's no window,
+        //  the worker just serves requests until the parent goes away
+        auto worker = std::make_unique<PluginSandboxWorker>();
+        if (worker->initialiseFromCommandLine (commandLine, PluginSandbox::processUID)) {
+            sandboxWorker = std::move (worker);
+            return;
+        }
+
+        if (commandLine.contains ("--sandbox-bench")) {
+            setApplicationReturnValue (PluginSandbox::runBenchmark (juce::StringArray::fromTokens (commandLine, true)));
+            quit();
+            return;
+        }
+
+        // Offline renders never touch an audio device or open a window, so
+        //  they work on machines without either
+        if (commandLine.contains ("--render")) {
+            setApplicationReturnValue (OfflineRenderer::run (juce::StringArray::fromTokens (commandLine, true)));
+            quit();
+            return;
+        }
+
+        // Sandboxes of a host that crashed leave their audio rings behind
+        SharedAudioRing::removeStaleFiles();
+
+        // Live mode is for dedicated Linux machines, see LiveMode
+        mainWindow.reset (new MainWindow (getApplicationName(), commandLine.contains ("--live")));
     }
 
     void shutdown() override
@@ -28,6 +55,7 @@ public:
         // Add your application's shutdown code here..
 
         mainWindow = nullptr; // (deletes our window)
+        sandboxWorker = nullptr;
     }
 
     //==============================================================================
@@ -54,14 +82,14 @@ public:
     class MainWindow final : public juce::DocumentWindow
     {
     public:
-        explicit MainWindow (juce::String name)
+        MainWindow (juce::String name, bool liveMode)
             : DocumentWindow (name,
                               juce::Desktop::getInstance().getDefaultLookAndFeel()
                                                           .findColour (backgroundColourId),
                               allButtons)
         {
             setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
+            setContentOwned (new MainComponent (liveMode), true);
 
             setResizable (true, true);
             centreWithSize (getWidth(), getHeight());
@@ -94,6 +122,7 @@ public:
 
 private:
     std::unique_ptr<MainWindow> mainWindow;
+    std::unique_ptr<PluginSandboxWorker> sandboxWorker;
 };
 
 //==============================================================================
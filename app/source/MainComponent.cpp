@@ -35,9 +35,21 @@
 
 
 // ****************************************************************************
-MainComponent::MainComponent() {
-
-    pluginsActive = false;
+MainComponent::MainComponent (bool live)
+    : liveMode (live) {
+
+    // Build the board and compile its (still empty) slots so the audio
+    //  callback has a schedule to run from the first block
+    signalGraph.setTopology (BoardTopology::createDefaultBoard());
+    granularSlot = signalGraph.findSlot ("Granular");
+    looperSlot = signalGraph.findSlot ("Looper");
+
+    // The looper is built in, so it's there before any plugins are scanned
+    signalGraph.swapSlotPlugin (looperSlot, std::make_unique<LooperProcessor>());
+    signalGraph.setProfiler (&audioProfiler);
+    if (liveMode.isEnabled())
+        signalGraph.setWorkerCores (liveMode.getWorkerCores(), LiveMode::workerPriority);
+    signalGraph.prepare (preferredSampleRate, preferredBufferSize);
 
     menuBar = std::make_unique<juce::MenuBarComponent>(this);
     addAndMakeVisible(menuBar.get());
@@ -70,8 +82,8 @@ MainComponent::MainComponent() {
                     devSetup.outputDeviceName = d;
                     devSetup.inputChannels = 0;
                     devSetup.outputChannels = 0;
-                    devSetup.sampleRate = mySampleRate;
-                    devSetup.bufferSize = myBufferSize;
+                    devSetup.sampleRate = preferredSampleRate;
+                    devSetup.bufferSize = preferredBufferSize;
                     devSetup.useDefaultInputChannels = true;
                     devSetup.useDefaultOutputChannels = true;
                     juce::String error = audioDeviceManager.setAudioDeviceSetup(devSetup, true);
@@ -83,20 +95,29 @@ MainComponent::MainComponent() {
         }
     }
 
-    // Load our main window background image
-    auto* data = BinaryData::pedalboard_jpg;
-    int   size = BinaryData::pedalboard_jpgSize;
-    backgroundImage = juce::ImageFileFormat::loadFrom(data, size);
-
-    // Set up our level meter
+    // Set up our level meter, with the DSP load beside it
     addAndMakeVisible(levelMeter);
+    dspLoadLabel.setFont (juce::FontOptions (12.0f));
+    dspLoadLabel.setColour (juce::Label::textColourId, juce::Colours::white);
+    dspLoadLabel.setJustificationType (juce::Justification::centredLeft);
+    addAndMakeVisible(dspLoadLabel);
 
     audioDeviceManager.initialiseWithDefaultDevices(2, 2);
     audioDeviceManager.addAudioCallback(this);
 
-    peakReset = true;
+    // Footswitches and expression pedals work as soon as they're plugged in,
+    //  and the mapping file is written out the first time so it can be edited
+    if (! midiController.loadMappings (MidiController::getDefaultMappingFile()))
+        midiController.saveMappings (MidiController::getDefaultMappingFile());
+    for (auto& input : juce::MidiInput::getAvailableDevices())
+        audioDeviceManager.setMidiInputDeviceEnabled (input.identifier, true);
+    audioDeviceManager.addMidiInputDeviceCallback ({}, &midiController);
+    bufferTuner.applySaved (getBoardKey());
+
     startTimer(30);
 
+    // The background covers every pixel, so nothing behind us needs painting
+    setOpaque (true);
     setSize (800, 600);
 
     // Call the function to look for and load our plugins. We do it this way
@@ -115,24 +136,18 @@ MainComponent::MainComponent() {
 MainComponent::~MainComponent() {
 
     scanDialog.reset();
+    audioDeviceManager.removeMidiInputDeviceCallback ({}, &midiController);
     audioDeviceManager.removeAudioCallback(this);
     granularPluginWindow = nullptr;
-    if (granularPlugin != nullptr) {
-        granularPlugin->releaseResources();
-        granularPlugin.reset();
-    }
-    granularPluginBuffer.setSize (0, 0);
+    signalGraph.releaseResources();
 }
 
 // ****************************************************************************
 void MainComponent::paint (juce::Graphics& g) {
 
-    if (backgroundImage.isValid()) {
-        // The image will automatically scale to fill the new size
-        g.drawImage(backgroundImage, getLocalBounds().toFloat(),
-        juce::RectanglePlacement::fillDestination);
-    }
-    else {
+    // The background is decoded and scaled to our size off the message
+    //  thread, until then we just show the name
+    if (! background.draw(g, getLocalBounds())) {
         g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
         g.setFont (juce::FontOptions (16.0f));
         g.setColour (juce::Colours::white);
@@ -149,7 +164,8 @@ void MainComponent::resized() {
     // Create status bar at bottom
     auto statusBar = bounds.removeFromBottom(20);
         
-    // Position meter in status bar with some padding
+    // DSP load on the right, meter in the rest with some padding
+    dspLoadLabel.setBounds(statusBar.removeFromRight(260));
     auto meterBounds = statusBar.reduced(1);
     levelMeter.setBounds(meterBounds);
 }
@@ -157,7 +173,7 @@ void MainComponent::resized() {
 // ****************************************************************************
 juce::StringArray MainComponent::getMenuBarNames() {
 
-    return { "File", "Settings", "Help" };
+    return { "File", "Scenes", "Looper", "Settings", "Help" };
 }
 
 // ****************************************************************************
@@ -171,9 +187,44 @@ juce::PopupMenu MainComponent::getMenuForIndex (int topLevelMenuIndex, const juc
         menu.addItem (3, "Quit");
     }
     else if (topLevelMenuIndex == 1) {
-        menu.addItem (4, "Audio Driver");
+        menu.addItem (8, "Store Scene");
+        menu.addSeparator();
+        for (int i = 0; i < sceneCache.getNumScenes(); ++i)
+            if (! sceneCache.isSceneDiscarded (i))
+                menu.addItem (firstSceneMenuId + i, sceneCache.getSceneName (i), true, i == signalGraph.getCurrentScene());
     }
     else if (topLevelMenuIndex == 2) {
+        auto* looper = getLooper();
+        const bool hasLooper = looper != nullptr;
+        menu.addItem (10, "Record", hasLooper);
+        menu.addItem (11, "Overdub", hasLooper);
+        menu.addItem (12, "Multiply", hasLooper);
+        menu.addSeparator();
+        menu.addItem (13, "Undo Layer", hasLooper && looper->getNumLayers() > 1);
+        menu.addItem (14, "Redo Layer", hasLooper);
+        menu.addSeparator();
+        menu.addItem (15, "Play / Stop", hasLooper);
+        menu.addItem (16, "Clear", hasLooper);
+    }
+    else if (topLevelMenuIndex == 3) {
+        menu.addItem (4, "Audio Driver");
+        menu.addItem (6, "Pipelined Plugin Chains", true, signalGraph.isPipelined());
+        menu.addItem (7, "Host Plugins Out Of Process", true, hostOutOfProcess);
+        menu.addItem (9, "Record DSP Trace", true, audioProfiler.isTracing());
+        menu.addItem (17, "Tune Buffer Size", true, bufferTuner.isTuning());
+        menu.addItem (18, "Plugin Sleep Stats");
+        menu.addItem (19, "Slot Watchdog", true, watchdogEnabled);
+        menu.addItem (20, "Restore Bypassed Slots", ! watchdogBypassed.isEmpty());
+
+        juce::PopupMenu blockSizes;
+        blockSizes.addItem (firstBlockSizeMenuId, "Follow Device", true, signalGraph.getFixedBlockSize() == 0);
+        for (size_t i = 0; i < std::size (fixedBlockSizes); ++i)
+            blockSizes.addItem (firstBlockSizeMenuId + 1 + (int) i, juce::String (fixedBlockSizes[i]) + " Samples",
+                                true, signalGraph.getFixedBlockSize() == fixedBlockSizes[i]);
+        menu.addSubMenu ("Internal Block Size", blockSizes);
+    }
+    else if (topLevelMenuIndex == 4) {
+        menu.addItem (21, "Live Mode Report");
         menu.addItem (5, "About");
     }
     return menu;
@@ -182,8 +233,32 @@ juce::PopupMenu MainComponent::getMenuForIndex (int topLevelMenuIndex, const juc
 // ****************************************************************************
 void MainComponent::menuItemSelected (int menuItemID, int) {
 
+    if (menuItemID >= firstSceneMenuId) {
+        // The editor may belong to a plugin that's about to be unloaded
+        granularPluginWindow = nullptr;
+        sceneCache.recallScene (menuItemID - firstSceneMenuId);
+        return;
+    }
+
+    if (menuItemID >= firstBlockSizeMenuId) {
+        // Plugins are prepared for the internal block size, so they have to
+        //  go through a device restart to pick it up
+        const auto index = menuItemID - firstBlockSizeMenuId;
+        signalGraph.setFixedBlockSize (index == 0 ? 0 : fixedBlockSizes[(size_t) index - 1]);
+        audioDeviceManager.closeAudioDevice();
+        audioDeviceManager.restartLastAudioDevice();
+        juce::Logger::writeToLog ("Latency: " + juce::String (signalGraph.getLatencySamples()) + " samples");
+        return;
+    }
+
     switch(menuItemID) {
-        case 4:
+        case 1:
+            openBoard();
+        break;
+        case 2:
+            saveBoard (boardFile == juce::File());
+        break;
+        case 4: {
             auto* popup = new Settings(audioDeviceManager);
             popup->setSize (600, 400);
             juce::DialogWindow::LaunchOptions options;
@@ -195,6 +270,56 @@ void MainComponent::menuItemSelected (int menuItemID, int) {
             options.resizable                  = false;
             options.componentToCentreAround    = this;        // center on parent
             options.launchAsync();
+        }
+        break;
+        case 6:
+            // Trades one block of latency per chained plugin for running
+            //  every stage of the chain on its own core
+            signalGraph.setPipelined (! signalGraph.isPipelined());
+            if (signalGraph.rebuild())
+                juce::Logger::writeToLog ("Pipeline latency: " + juce::String (signalGraph.getLatencySamples()) + " samples");
+        break;
+        case 7:
+            // Applies to plugins loaded from now on
+            hostOutOfProcess = ! hostOutOfProcess;
+        break;
+        case 8:
+            sceneCache.storeCurrentScene ("Scene " + juce::String (sceneCache.getNumScenes() + 1));
+        break;
+        case 9:
+            toggleTrace();
+        break;
+        case 17:
+            if (bufferTuner.isTuning())
+                bufferTuner.cancel();
+            else
+                tuneBufferSize();
+        break;
+        case 18:
+            showSleepStats();
+        break;
+        case 19:
+            watchdogEnabled = ! watchdogEnabled;
+            updateWatchdog();
+        break;
+        case 20:
+            signalGraph.restoreWatchdogBypasses();
+            watchdogBypassed.clear();
+        break;
+        case 21:
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::InfoIcon, "Live Mode",
+                                                    liveMode.getReport (signalGraph.getWorkerPool()));
+        break;
+        case 10: case 11: case 12: case 13: case 14: case 15: case 16:
+            if (auto* looper = getLooper()) {
+                static constexpr LooperProcessor::Command commands[] = {
+                    LooperProcessor::Command::record, LooperProcessor::Command::overdub,
+                    LooperProcessor::Command::multiply, LooperProcessor::Command::undo,
+                    LooperProcessor::Command::redo, LooperProcessor::Command::togglePlay,
+                    LooperProcessor::Command::clear
+                };
+                looper->trigger (commands[menuItemID - 10]);
+            }
         break;
     }
 }
@@ -202,12 +327,84 @@ void MainComponent::menuItemSelected (int menuItemID, int) {
 // ****************************************************************************
 void MainComponent::timerCallback(void) {
 
-    levelMeter.setLevel(currentLevel.load());
-    peakReset = true;
+    // The level meter shows the guitar as it comes in, peak since the last tick
+    auto& nodes = signalGraph.getTopology().getNodes();
+    for (size_t n = 0; n < nodes.size(); ++n)
+        if (nodes[n].kind == NodeKind::input)
+            if (auto* tap = signalGraph.getMeters().getTapForNode ((int) n))
+                levelMeter.setLevel (juce::Decibels::gainToDecibels (tap->readAndReset()[0].peak));
+
+    // The profiler reports nodes by index, so it needs the names of the
+    //  scene that's playing
+    if (profiledScene != signalGraph.getCurrentScene()) {
+        profiledScene = signalGraph.getCurrentScene();
+        juce::StringArray names;
+        for (auto& node : signalGraph.getTopology().getNodes())
+            names.add (node.name);
+        audioProfiler.setNodeNames (names);
+    }
+
+    const auto dsp = audioProfiler.getSummary();
+    auto status = "DSP " + juce::String (juce::roundToInt (dsp.load * 100.0)) + "% (peak "
+                  + juce::String (juce::roundToInt (dsp.peakLoad * 100.0)) + "%)";
+    if (dsp.worstNodeName.isNotEmpty())
+        status << "  worst: " << dsp.worstNodeName << " " << juce::String (dsp.worstNodeP99Us / 1000.0, 2) << " ms";
+    if (bufferTuner.isTuning())
+        status = bufferTuner.getStatus() + "  " + status;
+
+    // The audio thread only flags a slot the watchdog took out, the telling
+    //  happens here
+    updateWatchdog();
+    for (auto& name : signalGraph.takeWatchdogTrips()) {
+        juce::Logger::writeToLog ("Watchdog bypassed " + name + ": repeatedly over its share of the block");
+        watchdogBypassed.addIfNotAlreadyThere (name);
+    }
+    if (! watchdogBypassed.isEmpty())
+        status = "Bypassed: " + watchdogBypassed.joinIntoString (", ") + "  " + status;
+    dspLoadLabel.setText (status, juce::dontSendNotification);
+
+    // Once per device start, what live mode actually managed to get
+    juce::String liveReport;
+    if (liveMode.takeReport (liveReport, signalGraph.getWorkerPool()))
+        juce::Logger::writeToLog (liveReport);
+
+    // Scene changes from MIDI need the message thread
+    const auto midiScene = midiController.takePendingScene();
+    if (juce::isPositiveAndBelow (midiScene, sceneCache.getNumScenes()) && ! sceneCache.isSceneDiscarded (midiScene)) {
+        granularPluginWindow = nullptr;
+        sceneCache.recallScene (midiScene);
+    }
+
+    signalGraph.collectGarbage();
+    sceneCache.collectGarbage();
+
+    // Plugin states are picked up a slot at a time, so an autosave only has
+    //  to write out what's already been captured, and only if it changed
+    const auto now = juce::Time::getMillisecondCounter();
+    if (now - lastCapture > captureIntervalMs) {
+        sceneCache.captureNextSlot();
+        lastCapture = now;
+    }
+    if (boardFile != juce::File() && now - lastAutosave > autosaveIntervalMs && sceneCache.hasUnsavedChanges())
+        saveBoard (false, false);
 }
 
 // ****************************************************************************
 void MainComponent::audioDeviceAboutToStart(juce::AudioIODevice* device) {
+
+    // Plugins are released whenever the device stops, so bring them back at
+    //  whatever the driver is actually running, which after a change in the
+    //  Settings dialog may be a different rate, block size or device entirely
+    const auto sampleRate = device->getCurrentSampleRate();
+    const auto blockSize = device->getCurrentBufferSizeSamples();
+    juce::Logger::writeToLog ("Audio device: " + device->getName() + " at " + juce::String (sampleRate, 0)
+                              + " Hz, " + juce::String (blockSize) + " samples");
+
+    audioProfiler.setSampleRate (sampleRate);
+    bufferTuner.deviceStarted (sampleRate);
+    midiController.prepare (sampleRate);
+    signalGraph.prepare (sampleRate, blockSize);
+    liveMode.deviceStarting();
 }
 
 // ****************************************************************************
@@ -219,63 +416,25 @@ void MainComponent::audioDeviceIOCallbackWithContext(
     int numSamples,
     const juce::AudioIODeviceCallbackContext& context) {
 
-    if ((numInputChannels >= 1 ) && (numOutputChannels >= 2)) {
+    // Plugins don't all flush denormals themselves, and neither does the graph
+    juce::ScopedNoDenormals noDenormals;
+    liveMode.setUpAudioThread();
 
-        if (!pluginsActive) {
-            if ((inputChannelData[0] != nullptr) && 
-                (outputChannelData[0] != nullptr) && (outputChannelData[1] != nullptr)) {
-                memcpy(outputChannelData[0], inputChannelData[0], numSamples * sizeof(float));
-                memcpy(outputChannelData[1], inputChannelData[0], numSamples * sizeof(float));
-            }
-        }
-        else {
-            for (int ch = 0; ch < numOutputChannels; ++ch) {
-                if (auto* out = outputChannelData[ch]) {
-                    juce::FloatVectorOperations::clear (out, numSamples);
-                }
-            }
-            granularPluginBuffer.clear();
-
-            granularPluginBuffer.copyFrom(0, 0, inputChannelData[0], numSamples);
-            granularPluginBuffer.copyFrom(1, 0, inputChannelData[0], numSamples);
- 
-            juce::MidiBuffer midi; // empty MIDI for now
-            granularPlugin->processBlock (granularPluginBuffer, midi);
-
-            const float* pSrcL = granularPluginBuffer.getReadPointer(0);
-            const float* pSrcR = granularPluginBuffer.getReadPointer(1);
-            memcpy(outputChannelData[0], pSrcL, numSamples * sizeof(float));
-            memcpy(outputChannelData[1], pSrcR, numSamples * sizeof(float));            
-        }
-    }    
+    juce::ignoreUnused (context);
+    bufferTuner.callbackStarted (numSamples);
 
-    if (peakReset) {
-        peakReset = false;
-        currentLevel.store(-100.0f);
-    }
-    float peak = 0.0f;
-    for (int i = 0; i < numSamples; i++) {
-        float absolute = abs(inputChannelData[0][i]);
-        if (absolute > peak)
-            peak = absolute;
-    }
-    float peakDb = Decibels::gainToDecibels(peak);
-
-    if (peakDb > currentLevel.load())
-        currentLevel.store(peakDb);
+    // Every node of the board is metered as the graph runs
+    const auto numMidiEvents = midiController.popEvents (midiEvents.data(), (int) midiEvents.size(), numSamples);
+    signalGraph.process (inputChannelData, numInputChannels,
+                         outputChannelData, numOutputChannels, numSamples,
+                         midiEvents.data(), numMidiEvents);
 }
 
 
 // ****************************************************************************
 void MainComponent::audioDeviceStopped() {
 
-    granularPluginWindow = nullptr;
-
-    if (granularPlugin != nullptr) {
-        granularPlugin->releaseResources();
-        granularPlugin.reset();
-    }
-    granularPluginBuffer.setSize (0, 0);
+    signalGraph.releaseResources();
 }
 
 // ****************************************************************************
@@ -291,48 +450,177 @@ void MainComponent::startPluginScan() {
     dialog->setVisible(true);
     scanDialog.reset(dialog);
     addDefaultFormatsToManager(formatManager);
-    juce::Timer::callAfterDelay (2000, [this]() {
-        pluginScanner();
+
+    // The scan runs on background threads and only re-probes plugin files
+    //  that changed since the last launch
+    pluginScanCache.startScan (
+    [safe = juce::Component::SafePointer<MainComponent>(this)]
+    {
+        if (safe != nullptr)
+            safe->pluginScanner();
     });
 }
 
 // ****************************************************************************
 void MainComponent::pluginScanner() {
 
-    auto* format = formatManager.getFormat(0);  // VST3 on Windows/macOS
-    if (format == nullptr)
-        return;
+    scanDialog = nullptr;
 
-    juce::OwnedArray<juce::PluginDescription> types;
-    juce::File pluginFile ("C:/Program Files/Common Files/VST3/Velvet Machine.vst3");
-    format->findAllTypesForFile (types, pluginFile.getFullPathName());
-    if (types.isEmpty()) {
+    auto description = pluginScanCache.findPlugin ("Velvet Machine");
+    if (description == nullptr) {
         DBG ("Plugin not found!");
         return;
     }
 
-    juce::String error;
-    auto instance = formatManager.createPluginInstance (*types[0], mySampleRate, myBufferSize, error);
-    if (instance == nullptr) {
-        DBG ("Failed to create plugin instance: " << error);
+    // Creation and prepareToPlay happen on the loader thread, the graph then
+    //  crossfades from whatever the slot was running before
+    pluginLoader.load (*description, {}, signalGraph.getSampleRate(), signalGraph.getMaxBlockSize(), hostOutOfProcess,
+    [safe = juce::Component::SafePointer<MainComponent>(this)] (std::unique_ptr<juce::AudioPluginInstance> instance,
+                                                                const juce::String& error)
+    {
+        if (safe == nullptr)
+            return;
+        if (instance == nullptr) {
+            DBG ("Failed to create plugin instance: " << error);
+            return;
+        }
+
+        // The window belongs to the plugin we're about to retire
+        safe->granularPluginWindow = nullptr;
+        safe->signalGraph.swapSlotPlugin (safe->granularSlot, std::move (instance));
+    });
+}
+
+// ****************************************************************************
+void MainComponent::toggleTrace() {
+
+    if (audioProfiler.isTracing()) {
+        audioProfiler.stopTrace();
         return;
     }
 
-    granularPlugin = std::move (instance);
+    auto file = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                    .getNonexistentChildFile ("MoodBoard Trace " + juce::Time::getCurrentTime().formatted ("%Y-%m-%d %H-%M-%S"), ".json");
+
+    if (audioProfiler.startTrace (file))
+        juce::Logger::writeToLog ("Recording DSP trace to " + file.getFullPathName());
+}
 
-    auto layout = granularPlugin->getBusesLayout();
-    auto stereo = juce::AudioChannelSet::stereo();
-    layout.getChannelSet(true, 0)  = stereo;  // input
-    layout.getChannelSet(false, 0) = stereo;  // output
-    if (granularPlugin->checkBusesLayoutSupported(layout)) {
-        granularPlugin->setBusesLayout(layout);
+// ****************************************************************************
+void MainComponent::tuneBufferSize() {
+
+    // Steps the device down through its buffer sizes with this board running
+    //  and keeps the smallest one it survives
+    bufferTuner.start (getBoardKey(), [this] (int bufferSize, const juce::Array<BufferSizeTuner::Trial>& trials) {
+        juce::String report;
+        for (auto& trial : trials)
+            report << trial.bufferSize << " samples: load " << juce::roundToInt (trial.peakLoad * 100.0) << "%, jitter "
+                   << juce::roundToInt (trial.jitter * 100.0) << "%, " << trial.xruns << " xruns"
+                   << (trial.stable ? "" : " (unstable)") << "\n";
+        report << "\nUsing " << bufferSize << " samples";
+        juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::InfoIcon, "Tune Buffer Size", report);
+    });
+    updateWatchdog();
+}
+
+// ****************************************************************************
+void MainComponent::showSleepStats() {
+
+    // How much of the time each plugin of the running scene has been skipped
+    //  for silence, either on its own or with the unplayed A/B path
+    juce::String report;
+    for (int i = 0; i < signalGraph.getNumSlots(); ++i) {
+        auto& slot = signalGraph.getSlot (i);
+        if (slot.plugin == nullptr)
+            continue;
+
+        const auto slept = (double) slot.processor->sleptSamples.load();
+        const auto total = slept + (double) slot.processor->processedSamples.load();
+        report << slot.name << ": asleep " << juce::roundToInt (total > 0.0 ? 100.0 * slept / total : 0.0)
+               << "%, woken " << slot.processor->wakeups.load() << " times\n";
     }
 
-    granularPluginBuffer.setSize (granularPlugin->getTotalNumOutputChannels(), myBufferSize);
-    granularPlugin->prepareToPlay (mySampleRate, myBufferSize);
+    if (report.isEmpty())
+        report = "No plugins loaded";
+    juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::InfoIcon, "Plugin Sleep Stats", report);
+}
 
-    scanDialog = nullptr;
-    pluginsActive = true;
+// ****************************************************************************
+void MainComponent::updateWatchdog() {
+
+    // A bypass during a tuning trial would make a size look stable only
+    //  because the heaviest pedal had gone, so the watchdog sits those out
+    const bool armed = watchdogEnabled && ! bufferTuner.isTuning();
+    signalGraph.setWatchdogBudget (armed ? watchdogBudget : 0.0);
+}
+
+// ****************************************************************************
+juce::String MainComponent::getBoardKey() const {
+
+    return boardFile == juce::File() ? juce::String ("Untitled") : boardFile.getFullPathName();
+}
+
+// ****************************************************************************
+void MainComponent::openBoard() {
+
+    fileChooser = std::make_unique<juce::FileChooser> ("Open Board", boardFile, "*.moodboard");
+    fileChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+    [this] (const juce::FileChooser& chooser)
+    {
+        auto file = chooser.getResult();
+        if (file == juce::File())
+            return;
+
+        juce::String error;
+        auto reader = BoardFileReader::open (file, error);
+        if (reader == nullptr) {
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Open Board", error);
+            return;
+        }
+
+        // Only the index has been read so far; plugin states are pulled out
+        //  of the file as their scenes load
+        granularPluginWindow = nullptr;
+        sceneCache.loadBoard (reader->createScenes(), reader->getCurrentScene());
+        boardFile = file;
+        lastAutosave = juce::Time::getMillisecondCounter();
+        bufferTuner.applySaved (getBoardKey());
+    });
+}
+
+// ****************************************************************************
+void MainComponent::saveBoard (bool chooseFile, bool captureAll) {
+
+    if (chooseFile) {
+        fileChooser = std::make_unique<juce::FileChooser> ("Save Board", boardFile, "*.moodboard");
+        fileChooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+        [this] (const juce::FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+            if (file == juce::File())
+                return;
+
+            boardFile = file.withFileExtension ("moodboard");
+            saveBoard (false);
+        });
+        return;
+    }
+
+    // The board we're saving over may still hold states we never loaded
+    sceneCache.releaseBoardFile (boardFile);
+
+    int currentScene = 0;
+    auto scenes = sceneCache.createSnapshot (currentScene, captureAll);
+    boardWriter.save (boardFile, std::move (scenes), currentScene);
+    lastAutosave = juce::Time::getMillisecondCounter();
+}
+
+// ****************************************************************************
+LooperProcessor* MainComponent::getLooper() {
+
+    if (looperSlot < 0 || looperSlot >= signalGraph.getNumSlots())
+        return nullptr;
+    return dynamic_cast<LooperProcessor*> (signalGraph.getSlot (looperSlot).plugin.get());
 }
 
 // ****************************************************************************
@@ -345,9 +633,16 @@ int x, y;
     x = p.getX();
     y = p.getY();
 
+    auto& granularPlugin = signalGraph.getSlot (granularSlot).plugin;
     if (! granularPlugin)
         return;
 
+    // Sandboxed plugins show their editor from the child process
+    if (auto* sandboxed = dynamic_cast<SandboxedPlugin*> (granularPlugin.get())) {
+        sandboxed->showEditorWindow();
+        return;
+    }
+
     // Only create the window if we don’t already have one
     if (granularPluginWindow == nullptr)
         granularPluginWindow = std::make_unique<PluginWindow> (*granularPlugin);
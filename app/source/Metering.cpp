@@ -0,0 +1,248 @@
+// ****************************************************************************
+//     Filename: Metering.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Audio metering module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "Metering.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && JUCE_64BIT
+ #include <arm_neon.h>
+#endif
+
+// ****************************************************************************
+// 4x oversampling interpolator for true peak, as a polyphase windowed sinc
+//   with 8 taps per phase. Laid out [tap][phase] so one SIMD register holds
+//   all four phases of a tap. Phase 0 lands exactly on an input sample, which
+//   keeps the sample peak in the same register.
+
+namespace
+{
+    struct TruePeakCoefficients
+    {
+        alignas (16) float c[8][4];
+
+        TruePeakCoefficients() {
+
+            for (int tap = 0; tap < 8; ++tap) {
+                for (int phase = 0; phase < 4; ++phase) {
+                    const auto t = 4.0 - tap - phase / 4.0;
+                    const auto x = juce::MathConstants<double>::pi * t;
+                    const auto sinc = std::abs (t) < 1.0e-9 ? 1.0 : std::sin (x) / x;
+                    const auto window = std::abs (t) < 4.5 ? 0.5 + 0.5 * std::cos (juce::MathConstants<double>::pi * t / 4.5) : 0.0;
+                    c[tap][phase] = (float) (sinc * window);
+                }
+            }
+
+            // Unity gain at DC for every phase
+            for (int phase = 0; phase < 4; ++phase) {
+                float sum = 0.0f;
+                for (int tap = 0; tap < 8; ++tap)
+                    sum += c[tap][phase];
+                for (int tap = 0; tap < 8; ++tap)
+                    c[tap][phase] /= sum;
+            }
+        }
+    };
+
+    const TruePeakCoefficients truePeakCoefficients;
+}
+
+// ****************************************************************************
+void MeterTap::measure (const float* const* channels, int numChannels, int numSamples) {
+
+    const auto requests = resetRequests.load (std::memory_order_relaxed);
+    if (requests != handledResets) {
+        handledResets = requests;
+        peak.fill (0.0f);
+        truePeak.fill (0.0f);
+        sumOfSquares.fill (0.0);
+        numMeasured = 0;
+    }
+
+    const bool withTruePeak = truePeakEnabled.load (std::memory_order_relaxed);
+    numChannels = juce::jmin (numChannels, maxChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        float blockPeak = 0.0f, blockSum = 0.0f;
+        measurePeakAndPower (channels[ch], numSamples, blockPeak, blockSum);
+        peak[(size_t) ch] = juce::jmax (peak[(size_t) ch], blockPeak);
+        sumOfSquares[(size_t) ch] += blockSum;
+
+        if (withTruePeak)
+            truePeak[(size_t) ch] = juce::jmax (truePeak[(size_t) ch], blockPeak,
+                                                measureTruePeak (channels[ch], numSamples, history[(size_t) ch]));
+    }
+    numMeasured += numSamples;
+
+    // Seqlock write: odd while the values are in flux
+    const auto seq = sequence.load (std::memory_order_relaxed);
+    sequence.store (seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    for (int ch = 0; ch < maxChannels; ++ch) {
+        const auto rms = numMeasured > 0 ? (float) std::sqrt (sumOfSquares[(size_t) ch] / (double) numMeasured) : 0.0f;
+        published[(size_t) (ch * 3)].store (peak[(size_t) ch], std::memory_order_relaxed);
+        published[(size_t) (ch * 3 + 1)].store (rms, std::memory_order_relaxed);
+        published[(size_t) (ch * 3 + 2)].store (truePeak[(size_t) ch], std::memory_order_relaxed);
+    }
+
+    sequence.store (seq + 2, std::memory_order_release);
+}
+
+// ****************************************************************************
+MeterTap::Readings MeterTap::read() const {
+
+    Readings readings;
+
+    for (;;) {
+        const auto before = sequence.load (std::memory_order_acquire);
+        if ((before & 1) != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (int ch = 0; ch < maxChannels; ++ch) {
+            readings[(size_t) ch].peak     = published[(size_t) (ch * 3)].load (std::memory_order_relaxed);
+            readings[(size_t) ch].rms      = published[(size_t) (ch * 3 + 1)].load (std::memory_order_relaxed);
+            readings[(size_t) ch].truePeak = published[(size_t) (ch * 3 + 2)].load (std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (sequence.load (std::memory_order_relaxed) == before)
+            return readings;
+    }
+}
+
+// ****************************************************************************
+void MeterTap::measurePeakAndPower (const float* samples, int numSamples, float& peakOut, float& sumOut) {
+
+    int i = 0;
+    float blockPeak = 0.0f, blockSum = 0.0f;
+
+   #if JUCE_INTEL
+    const auto absMask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+    auto vPeak = _mm_setzero_ps();
+    auto vSum = _mm_setzero_ps();
+
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto v = _mm_loadu_ps (samples + i);
+        vPeak = _mm_max_ps (vPeak, _mm_and_ps (v, absMask));
+        vSum = _mm_add_ps (vSum, _mm_mul_ps (v, v));
+    }
+
+    alignas (16) float lanes[4];
+    _mm_store_ps (lanes, vPeak);
+    blockPeak = juce::jmax (lanes[0], lanes[1], lanes[2], lanes[3]);
+    _mm_store_ps (lanes, vSum);
+    blockSum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+   #elif JUCE_ARM && JUCE_64BIT
+    auto vPeak = vdupq_n_f32 (0.0f);
+    auto vSum = vdupq_n_f32 (0.0f);
+
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto v = vld1q_f32 (samples + i);
+        vPeak = vmaxq_f32 (vPeak, vabsq_f32 (v));
+        vSum = vmlaq_f32 (vSum, v, v);
+    }
+
+    blockPeak = vmaxvq_f32 (vPeak);
+    blockSum = vaddvq_f32 (vSum);
+   #endif
+
+    for (; i < numSamples; ++i) {
+        blockPeak = juce::jmax (blockPeak, std::abs (samples[i]));
+        blockSum += samples[i] * samples[i];
+    }
+
+    peakOut = blockPeak;
+    sumOut = blockSum;
+}
+
+// ****************************************************************************
+float MeterTap::measureTruePeak (const float* samples, int numSamples, std::array<float, truePeakHistory>& history) {
+
+    // Works through the block in chunks on the stack, each one prefixed with
+    //  the last samples of the one before
+    constexpr int chunkSize = 64;
+    float buffer[truePeakHistory + chunkSize];
+    float result = 0.0f;
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize) {
+        const int count = juce::jmin (chunkSize, numSamples - offset);
+        std::copy (history.begin(), history.end(), buffer);
+        std::copy (samples + offset, samples + offset + count, buffer + truePeakHistory);
+
+       #if JUCE_INTEL
+        const auto absMask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+        auto vPeak = _mm_setzero_ps();
+
+        for (int i = 0; i < count; ++i) {
+            const float* newest = buffer + truePeakHistory + i;
+            auto acc = _mm_setzero_ps();
+            for (int tap = 0; tap < 8; ++tap)
+                acc = _mm_add_ps (acc, _mm_mul_ps (_mm_load_ps (truePeakCoefficients.c[tap]), _mm_set1_ps (newest[-tap])));
+            vPeak = _mm_max_ps (vPeak, _mm_and_ps (acc, absMask));
+        }
+
+        alignas (16) float lanes[4];
+        _mm_store_ps (lanes, vPeak);
+        result = juce::jmax (result, juce::jmax (lanes[0], lanes[1], lanes[2], lanes[3]));
+       #elif JUCE_ARM && JUCE_64BIT
+        auto vPeak = vdupq_n_f32 (0.0f);
+
+        for (int i = 0; i < count; ++i) {
+            const float* newest = buffer + truePeakHistory + i;
+            auto acc = vdupq_n_f32 (0.0f);
+            for (int tap = 0; tap < 8; ++tap)
+                acc = vmlaq_n_f32 (acc, vld1q_f32 (truePeakCoefficients.c[tap]), newest[-tap]);
+            vPeak = vmaxq_f32 (vPeak, vabsq_f32 (acc));
+        }
+
+        result = juce::jmax (result, vmaxvq_f32 (vPeak));
+       #else
+        for (int i = 0; i < count; ++i) {
+            const float* newest = buffer + truePeakHistory + i;
+            for (int phase = 0; phase < 4; ++phase) {
+                float acc = 0.0f;
+                for (int tap = 0; tap < 8; ++tap)
+                    acc += truePeakCoefficients.c[tap][phase] * newest[-tap];
+                result = juce::jmax (result, std::abs (acc));
+            }
+        }
+       #endif
+
+        std::copy (buffer + count, buffer + count + truePeakHistory, history.begin());
+    }
+
+    return result;
+}
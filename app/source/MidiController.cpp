@@ -0,0 +1,253 @@
+// ****************************************************************************
+//     Filename: MidiController.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: MIDI footswitch and expression pedal input
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "MidiController.h"
+
+static const char* const triggerNames[] = { "controller", "note", "programChange" };
+static const char* const actionNames[] = { "forward", "toggleAB", "selectPath", "toggleBypass", "selectScene" };
+
+// ****************************************************************************
+template <typename Enum, size_t numNames>
+static Enum fromName (const char* const (&names)[numNames], const juce::String& name, Enum fallback) {
+
+    for (size_t i = 0; i < numNames; ++i)
+        if (name == names[i])
+            return (Enum) i;
+    return fallback;
+}
+
+// ****************************************************************************
+MidiController::MidiController() {
+
+    mappings = createDefaultMappings();
+}
+
+// ****************************************************************************
+MidiController::~MidiController() {
+}
+
+// ****************************************************************************
+juce::File MidiController::getDefaultMappingFile() {
+
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("MoodBoard")
+               .getChildFile ("MidiMappings.xml");
+}
+
+// ****************************************************************************
+juce::Array<MidiController::Mapping> MidiController::createDefaultMappings() {
+
+    // CC 80 switches paths, CC 81 - 85 bypass the five slots of the default
+    //  board and program changes recall scenes
+    juce::Array<Mapping> defaults;
+    defaults.add ({ Trigger::controller, 0, 80, Action::toggleAB, -1 });
+    for (int slot = 0; slot < 5; ++slot)
+        defaults.add ({ Trigger::controller, 0, 81 + slot, Action::toggleBypass, slot });
+    defaults.add ({ Trigger::programChange, 0, -1, Action::selectScene, -1 });
+    return defaults;
+}
+
+// ****************************************************************************
+void MidiController::setMappings (const juce::Array<Mapping>& newMappings) {
+
+    const juce::ScopedLock sl (mappingLock);
+    mappings = newMappings;
+}
+
+// ****************************************************************************
+juce::Array<MidiController::Mapping> MidiController::getMappings() const {
+
+    const juce::ScopedLock sl (mappingLock);
+    return mappings;
+}
+
+// ****************************************************************************
+bool MidiController::loadMappings (const juce::File& file) {
+
+    auto xml = juce::parseXML (file);
+    if (xml == nullptr || ! xml->hasTagName ("MIDIMAPPINGS"))
+        return false;
+
+    juce::Array<Mapping> loaded;
+    for (auto* entry : xml->getChildWithTagNameIterator ("MAPPING")) {
+        Mapping mapping;
+        mapping.trigger = fromName (triggerNames, entry->getStringAttribute ("trigger"), Trigger::controller);
+        mapping.channel = juce::jlimit (0, 16, entry->getIntAttribute ("channel", 0));
+        mapping.number = entry->getIntAttribute ("number", -1);
+        mapping.action = fromName (actionNames, entry->getStringAttribute ("action"), Action::forward);
+        mapping.target = entry->getIntAttribute ("target", -1);
+        loaded.add (mapping);
+    }
+
+    setMappings (loaded);
+    return true;
+}
+
+// ****************************************************************************
+bool MidiController::saveMappings (const juce::File& file) const {
+
+    juce::XmlElement xml ("MIDIMAPPINGS");
+    for (auto& mapping : getMappings()) {
+        auto* entry = xml.createNewChildElement ("MAPPING");
+        entry->setAttribute ("trigger", triggerNames[(int) mapping.trigger]);
+        entry->setAttribute ("channel", mapping.channel);
+        entry->setAttribute ("number", mapping.number);
+        entry->setAttribute ("action", actionNames[(int) mapping.action]);
+        entry->setAttribute ("target", mapping.target);
+    }
+
+    file.getParentDirectory().createDirectory();
+    return xml.writeTo (file);
+}
+
+// ****************************************************************************
+void MidiController::prepare (double sampleRate) {
+
+    currentSampleRate.store (sampleRate);
+}
+
+// ****************************************************************************
+int MidiController::popEvents (MidiEvent* events, int maxEvents, int numSamples) {
+
+    const auto sampleRate = currentSampleRate.load (std::memory_order_relaxed);
+
+    // This block stands for the one that has just gone by, so an event lands
+    //  as far into it as it arrived into that one
+    const auto blockStart = juce::Time::getMillisecondCounterHiRes() * 0.001 - numSamples / sampleRate;
+
+    int numEvents = 0;
+    const auto scope = fifo.read (juce::jmin (maxEvents, fifo.getNumReady()));
+
+    auto take = [&] (int start, int count) {
+        for (int i = start; i < start + count; ++i) {
+            auto& queued = queue[(size_t) i];
+            events[numEvents] = queued.event;
+            events[numEvents++].position = juce::jlimit (0, numSamples - 1, (int) ((queued.timestamp - blockStart) * sampleRate));
+        }
+    };
+
+    take (scope.startIndex1, scope.blockSize1);
+    take (scope.startIndex2, scope.blockSize2);
+    return numEvents;
+}
+
+// ****************************************************************************
+void MidiController::handleIncomingMidiMessage (juce::MidiInput*, const juce::MidiMessage& message) {
+
+    // Pedals don't send SysEx
+    const auto size = message.getRawDataSize();
+    if (size > 3)
+        return;
+
+    MidiEvent event;
+    event.size = size;
+    std::copy (message.getRawData(), message.getRawData() + size, event.data.begin());
+
+    // The queue only takes one writer. The device manager happens to call
+    //  back for all inputs under its own lock, but that's its business, so
+    //  the push stays under ours as well.
+    const juce::ScopedLock sl (mappingLock);
+
+    for (auto& mapping : mappings) {
+        if (! matches (mapping, message))
+            continue;
+
+        switch (mapping.action) {
+            case Action::forward:
+                event.target = mapping.target;
+            break;
+
+            case Action::selectScene:
+                pendingScene.store (mapping.target >= 0 ? mapping.target : message.getProgramChangeNumber());
+            return;
+
+            case Action::selectPath:
+                if (mapping.target < 0) {
+                    event.kind = MidiEvent::Kind::selectPath;
+                    event.target = message.getControllerValue() >= 64 ? 1 : 0;
+                    break;
+                }
+                [[fallthrough]];
+
+            case Action::toggleAB:
+            case Action::toggleBypass:
+                if (! isPress (message))
+                    return;
+                event.kind = mapping.action == Action::toggleAB     ? MidiEvent::Kind::toggleAB
+                           : mapping.action == Action::toggleBypass ? MidiEvent::Kind::toggleBypass
+                                                                    : MidiEvent::Kind::selectPath;
+                event.target = mapping.target;
+            break;
+        }
+        break;
+    }
+
+    push (message.getTimeStamp(), event);
+}
+
+// ****************************************************************************
+void MidiController::push (double timestamp, const MidiEvent& event) {
+
+    // A full queue means the audio thread has stalled, so dropping is fine
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 > 0)
+        queue[(size_t) scope.startIndex1] = { timestamp, event };
+    else if (scope.blockSize2 > 0)
+        queue[(size_t) scope.startIndex2] = { timestamp, event };
+}
+
+// ****************************************************************************
+bool MidiController::matches (const Mapping& mapping, const juce::MidiMessage& message) {
+
+    if (mapping.channel != 0 && mapping.channel != message.getChannel())
+        return false;
+
+    switch (mapping.trigger) {
+        case Trigger::controller:
+            return message.isController() && (mapping.number < 0 || mapping.number == message.getControllerNumber());
+        case Trigger::note:
+            return (message.isNoteOn() || message.isNoteOff())
+                   && (mapping.number < 0 || mapping.number == message.getNoteNumber());
+        case Trigger::programChange:
+            return message.isProgramChange() && (mapping.number < 0 || mapping.number == message.getProgramChangeNumber());
+    }
+    return false;
+}
+
+// ****************************************************************************
+bool MidiController::isPress (const juce::MidiMessage& message) {
+
+    if (message.isController())
+        return message.getControllerValue() >= 64;
+    return message.isNoteOn() || message.isProgramChange();
+}
@@ -0,0 +1,253 @@
+// ****************************************************************************
+//     Filename: OfflineRenderer.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Headless offline render module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "OfflineRenderer.h"
+#include "BoardFile.h"
+#include "Looper.h"
+
+// ****************************************************************************
+OfflineRenderer::OfflineRenderer() {
+
+    addDefaultFormatsToManager (formatManager);
+}
+
+// ****************************************************************************
+bool OfflineRenderer::loadBoard (const juce::File& file, double sampleRate, int maxBlockSize, juce::String& error) {
+
+    auto reader = BoardFileReader::open (file, error);
+    if (reader == nullptr)
+        return false;
+
+    auto scenes = reader->createScenes();
+    if (scenes.empty()) {
+        error = "Board has no scenes";
+        return false;
+    }
+
+    const auto current = juce::jlimit (0, (int) scenes.size() - 1, reader->getCurrentScene());
+    return installScene (scenes[(size_t) current], sampleRate, maxBlockSize, error);
+}
+
+// ****************************************************************************
+bool OfflineRenderer::loadDefaultBoard (double sampleRate, int maxBlockSize, juce::String& error) {
+
+    SceneRecipe recipe;
+    recipe.name = "Default";
+    recipe.topology = BoardTopology::createDefaultBoard();
+
+    for (auto& node : recipe.topology.getNodes()) {
+        if (node.kind == NodeKind::slot && node.name == "Looper") {
+            SlotRecipe looper;
+            looper.slot = node.slot;
+            looper.description = LooperProcessor::getDescription();
+            recipe.plugins.push_back (std::move (looper));
+        }
+    }
+
+    return installScene (recipe, sampleRate, maxBlockSize, error);
+}
+
+// ****************************************************************************
+bool OfflineRenderer::installScene (const SceneRecipe& recipe, double sampleRate, int maxBlockSize, juce::String& error) {
+
+    // Nothing is playing, so the scene can be filled in directly instead of
+    //  crossfading each plugin in
+    const auto scene = signalGraph.addScene (recipe.name, recipe.topology);
+
+    for (auto& plugin : recipe.plugins) {
+        if (! juce::isPositiveAndBelow (plugin.slot, (int) signalGraph.getScene (scene).slots.size()))
+            continue;
+
+        juce::MemoryBlock state;
+        if (! plugin.getState (state)) {
+            error = "Unable to read the state of " + plugin.description.name;
+            return false;
+        }
+
+        auto instance = pluginLoader.loadNow (plugin.description, state, sampleRate, maxBlockSize,
+                                              plugin.outOfProcess, error);
+        if (instance == nullptr) {
+            error = plugin.description.name + ": " + error;
+            return false;
+        }
+
+        signalGraph.setScenePlugin (scene, plugin.slot, std::move (instance));
+    }
+
+    if (! signalGraph.selectScene (scene)) {
+        error = "Unable to compile " + recipe.name;
+        return false;
+    }
+    return true;
+}
+
+// ****************************************************************************
+OfflineRenderer::Result OfflineRenderer::render (const juce::AudioBuffer<float>& input, double sampleRate,
+                                                 int blockSize, juce::AudioBuffer<float>& output) {
+
+    // Deletes any plugins the last render swapped out. Old schedules look
+    //  after themselves on the garbage collector thread.
+    signalGraph.collectGarbage();
+    signalGraph.prepare (sampleRate, blockSize);
+
+    // Renders don't run against the clock, so the watchdog would only bypass
+    //  plugins on a slow or busy machine
+    signalGraph.setWatchdogBudget (0.0);
+
+    const int latency = signalGraph.getLatencySamples();
+    const int numSamples = input.getNumSamples();
+    const int numInputChannels = input.getNumChannels();
+    const int totalSamples = numSamples + latency;
+
+    // Pad the input so the tail that is still in flight comes out too, all
+    //  allocated before the clock starts
+    juce::AudioBuffer<float> source (juce::jmax (1, numInputChannels), totalSamples);
+    source.clear();
+    for (int ch = 0; ch < numInputChannels; ++ch)
+        source.copyFrom (ch, 0, input, ch, 0, numSamples);
+
+    juce::AudioBuffer<float> rendered (2, totalSamples);
+    std::vector<const float*> inputs ((size_t) source.getNumChannels());
+    std::vector<float*> outputs (2);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int offset = 0; offset < totalSamples; offset += blockSize) {
+        const int count = juce::jmin (blockSize, totalSamples - offset);
+        for (size_t ch = 0; ch < inputs.size(); ++ch)
+            inputs[ch] = source.getReadPointer ((int) ch, offset);
+        for (size_t ch = 0; ch < outputs.size(); ++ch)
+            outputs[ch] = rendered.getWritePointer ((int) ch, offset);
+
+        signalGraph.process (inputs.data(), (int) inputs.size(), outputs.data(), (int) outputs.size(), count);
+    }
+
+    Result result;
+    result.blockSize = blockSize;
+    result.audioSeconds = numSamples / sampleRate;
+    result.renderSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+    output.setSize (2, numSamples);
+    for (int ch = 0; ch < 2; ++ch)
+        output.copyFrom (ch, 0, rendered, ch, latency, numSamples);
+
+    return result;
+}
+
+// ****************************************************************************
+int OfflineRenderer::run (const juce::StringArray& args) {
+
+    auto argument = [&args] (const juce::String& name) {
+        const auto index = args.indexOf (name);
+        return index >= 0 && index + 1 < args.size() ? args[index + 1].unquoted() : juce::String();
+    };
+
+    const auto inputFile = juce::File::getCurrentWorkingDirectory().getChildFile (argument ("--render"));
+    const auto boardName = argument ("--board");
+    const auto outputName = argument ("--out");
+
+    std::vector<int> blockSizes;
+    for (auto& token : juce::StringArray::fromTokens (argument ("--block"), ",", {}))
+        if (token.getIntValue() > 0)
+            blockSizes.push_back (token.getIntValue());
+    if (blockSizes.empty())
+        blockSizes.push_back (256);
+
+    juce::AudioFormatManager audioFormats;
+    audioFormats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (audioFormats.createReaderFor (inputFile));
+    if (reader == nullptr) {
+        juce::Logger::writeToLog ("Unable to read " + inputFile.getFullPathName());
+        return 1;
+    }
+
+    // Read it all up front so the disk isn't part of the measurement
+    const auto sampleRate = reader->sampleRate;
+    juce::AudioBuffer<float> input ((int) reader->numChannels, (int) reader->lengthInSamples);
+    reader->read (&input, 0, input.getNumSamples(), 0, true, true);
+
+    OfflineRenderer renderer;
+    renderer.setPipelined (args.contains ("--pipelined"));
+
+    const auto maxBlockSize = *std::max_element (blockSizes.begin(), blockSizes.end());
+    juce::String error;
+    const auto loaded = boardName.isNotEmpty()
+        ? renderer.loadBoard (juce::File::getCurrentWorkingDirectory().getChildFile (boardName), sampleRate, maxBlockSize, error)
+        : renderer.loadDefaultBoard (sampleRate, maxBlockSize, error);
+
+    if (! loaded) {
+        juce::Logger::writeToLog ("Unable to load board: " + error);
+        return 1;
+    }
+
+    juce::Logger::writeToLog ("Rendering " + inputFile.getFileName() + ": " + juce::String (input.getNumSamples() / sampleRate, 1)
+                              + " s at " + juce::String (sampleRate, 0) + " Hz");
+
+    juce::AudioBuffer<float> output;
+    for (size_t i = 0; i < blockSizes.size(); ++i) {
+        // Only the first pass is kept, the others are just for timing
+        juce::AudioBuffer<float> scratch;
+        const auto result = renderer.render (input, sampleRate, blockSizes[i], i == 0 ? output : scratch);
+
+        juce::Logger::writeToLog ("Block " + juce::String (result.blockSize).paddedLeft (' ', 4) + ": "
+                                  + juce::String (result.renderSeconds, 3) + " s, "
+                                  + juce::String (result.getRealtimeFactor(), 1) + "x real time");
+    }
+
+    if (outputName.isEmpty())
+        return 0;
+
+    const auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile (outputName);
+    outputFile.deleteFile();
+
+    auto fileStream = std::make_unique<juce::FileOutputStream> (outputFile);
+    if (fileStream->failedToOpen()) {
+        juce::Logger::writeToLog ("Unable to create " + outputFile.getFullPathName());
+        return 1;
+    }
+
+    std::unique_ptr<juce::OutputStream> stream = std::move (fileStream);
+    auto writer = juce::WavAudioFormat().createWriterFor (stream, juce::AudioFormatWriterOptions{}
+                                                                       .withSampleRate (sampleRate)
+                                                                       .withNumChannels (output.getNumChannels())
+                                                                       .withBitsPerSample (24));
+
+    if (writer == nullptr || ! writer->writeFromAudioSampleBuffer (output, 0, output.getNumSamples())) {
+        juce::Logger::writeToLog ("Unable to write " + outputFile.getFullPathName());
+        return 1;
+    }
+
+    juce::Logger::writeToLog ("Wrote " + outputFile.getFullPathName());
+    return 0;
+}
@@ -0,0 +1,226 @@
+// ****************************************************************************
+//     Filename: PluginLoader.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Background plugin loader module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "PluginLoader.h"
+#include "PluginSandbox.h"
+#include "Looper.h"
+
+// ****************************************************************************
+PluginLoader::PluginLoader (juce::AudioPluginFormatManager& formats)
+    : juce::Thread ("Plugin loader"),
+      formatManager (formats) {
+}
+
+// ****************************************************************************
+PluginLoader::~PluginLoader() {
+
+    signalThreadShouldExit();
+    notify();
+    stopThread (stopTimeoutMs);
+}
+
+// ****************************************************************************
+void PluginLoader::load (const juce::PluginDescription& description, const juce::MemoryBlock& state,
+                         double sampleRate, int blockSize, bool outOfProcess, Callback onLoaded) {
+
+    {
+        const juce::ScopedLock sl (jobLock);
+        jobs.push_back ({ description, state, sampleRate, blockSize, outOfProcess, std::move (onLoaded) });
+    }
+
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::normal);
+    notify();
+}
+
+// ****************************************************************************
+static bool isHostedHere (const juce::PluginDescription& description, bool outOfProcess) {
+
+    return ! outOfProcess && description.fileOrIdentifier != LooperProcessor::identifier;
+}
+
+// ****************************************************************************
+static void preloadFiles (const juce::File& file) {
+
+    // Reading the binary once puts it in the file cache, so loading it on the
+    //  message thread maps it from memory instead of waiting on the disk
+    juce::Array<juce::File> files;
+    if (file.isDirectory())
+        files = file.findChildFiles (juce::File::findFiles, true);
+    else
+        files.add (file);
+
+    constexpr int bufferSize = 65536;
+    juce::HeapBlock<char> buffer;
+    buffer.malloc (bufferSize);
+
+    for (auto& f : files) {
+        juce::FileInputStream in (f);
+        while (in.openedOk() && ! in.isExhausted() && in.read (buffer.get(), bufferSize) > 0) {}
+    }
+}
+
+// ****************************************************************************
+void PluginLoader::run() {
+
+    while (! threadShouldExit()) {
+        Job job;
+        bool haveJob = false;
+        {
+            const juce::ScopedLock sl (jobLock);
+            if (! jobs.empty()) {
+                job = std::move (jobs.front());
+                jobs.pop_front();
+                haveJob = true;
+            }
+        }
+
+        if (! haveJob) {
+            wait (-1);
+            continue;
+        }
+
+        // A plugin in our own process is created, restored and prepared on
+        //  the message thread, as VST3 requires. Only the disk work is ours.
+        if (isHostedHere (job.description, job.outOfProcess)) {
+            preloadFiles (juce::File (job.description.fileOrIdentifier));
+            juce::MessageManager::callAsync ([safe = juce::WeakReference<PluginLoader> (this), job = std::move (job)] () mutable
+            {
+                if (safe != nullptr)
+                    safe->createOnMessageThread (std::move (job));
+            });
+            continue;
+        }
+
+        juce::String error;
+        auto instance = prepareInstance (job, error);
+
+        // std::function needs a copyable capture, so the instance rides in a shared_ptr
+        auto shared = std::make_shared<std::unique_ptr<juce::AudioPluginInstance>> (std::move (instance));
+        juce::MessageManager::callAsync ([shared, error, callback = std::move (job.onLoaded)]
+        {
+            callback (std::move (*shared), error);
+        });
+    }
+}
+
+// ****************************************************************************
+void PluginLoader::createOnMessageThread (Job job) {
+
+    if (findFormat (job.description) == nullptr) {
+        job.onLoaded (nullptr, "No compatible plugin format exists for this plugin");
+        return;
+    }
+
+    // The format may finish creating the plugin on a later message loop
+    //  iteration, but always calls back on the message thread
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    auto shared = std::make_shared<Job> (std::move (job));
+    formatManager.createPluginInstanceAsync (shared->description, shared->sampleRate, shared->blockSize,
+    [shared, startTime] (std::unique_ptr<juce::AudioPluginInstance> instance, const juce::String& error)
+    {
+        if (instance != nullptr)
+            finishInstance (*instance, *shared, startTime);
+        shared->onLoaded (std::move (instance), error);
+    });
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::AudioPluginInstance> PluginLoader::loadNow (const juce::PluginDescription& description,
+                                                                  const juce::MemoryBlock& state, double sampleRate,
+                                                                  int blockSize, bool outOfProcess, juce::String& error) {
+
+    // Same rule as for load(): our own process means the message thread
+    jassert (! isHostedHere (description, outOfProcess) || juce::MessageManager::existsAndIsCurrentThread());
+    return prepareInstance ({ description, state, sampleRate, blockSize, outOfProcess, {} }, error);
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::AudioPluginInstance> PluginLoader::prepareInstance (const Job& job, juce::String& error) {
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    auto instance = createInstance (job, error);
+
+    if (instance != nullptr)
+        finishInstance (*instance, job, startTime);
+
+    return instance;
+}
+
+// ****************************************************************************
+void PluginLoader::finishInstance (juce::AudioPluginInstance& instance, const Job& job, double startTime) {
+
+    auto layout = instance.getBusesLayout();
+    auto stereo = juce::AudioChannelSet::stereo();
+    layout.getChannelSet(true, 0)  = stereo;  // input
+    layout.getChannelSet(false, 0) = stereo;  // output
+    if (instance.checkBusesLayoutSupported(layout)) {
+        instance.setBusesLayout(layout);
+    }
+
+    if (! job.state.isEmpty())
+        instance.setStateInformation (job.state.getData(), (int) job.state.getSize());
+
+    instance.setRateAndBufferSizeDetails (job.sampleRate, job.blockSize);
+    instance.prepareToPlay (job.sampleRate, job.blockSize);
+    juce::Logger::writeToLog ("Loaded " + job.description.name + " in "
+                              + juce::String (juce::roundToInt (juce::Time::getMillisecondCounterHiRes() - startTime)) + " ms");
+}
+
+// ****************************************************************************
+juce::AudioPluginFormat* PluginLoader::findFormat (const juce::PluginDescription& description) const {
+
+    for (auto* format : formatManager.getFormats())
+        if (format->getName() == description.pluginFormatName)
+            return format;
+    return nullptr;
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::AudioPluginInstance> PluginLoader::createInstance (const Job& job, juce::String& error) {
+
+    // Built-in nodes are ours, so they never need the sandbox
+    if (job.description.fileOrIdentifier == LooperProcessor::identifier)
+        return std::make_unique<LooperProcessor>();
+
+    if (job.outOfProcess)
+        return SandboxedPlugin::create (job.description, job.sampleRate, job.blockSize, error);
+
+    if (findFormat (job.description) == nullptr) {
+        error = "No compatible plugin format exists for this plugin";
+        return nullptr;
+    }
+
+    // Only reached on the message thread, which is where the format wants it
+    return formatManager.createPluginInstance (job.description, job.sampleRate, job.blockSize, error);
+}
@@ -0,0 +1,782 @@
+// ****************************************************************************
+//     Filename: PluginSandbox.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Out-of-process plugin scanning and hosting module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "PluginSandbox.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/resource.h>
+#endif
+
+// ****************************************************************************
+// A trivial plugin that both sides know about, so the transport can be
+//   measured without any third-party VST3 installed.
+
+class SandboxTestPlugin final : public juce::AudioPluginInstance
+{
+public:
+    SandboxTestPlugin()
+        : AudioPluginInstance (BusesProperties().withInput  ("Input",  juce::AudioChannelSet::stereo())
+                                                .withOutput ("Output", juce::AudioChannelSet::stereo())) {
+    }
+
+    static juce::PluginDescription getDescription() {
+
+        juce::PluginDescription d;
+        d.name = "Sandbox Test Gain";
+        d.pluginFormatName = "Internal";
+        d.fileOrIdentifier = identifier;
+        d.numInputChannels = 2;
+        d.numOutputChannels = 2;
+        return d;
+    }
+
+    void fillInPluginDescription (juce::PluginDescription& d) const override   { d = getDescription(); }
+    const juce::String getName() const override                                 { return getDescription().name; }
+
+    void prepareToPlay (double, int) override           {}
+    void releaseResources() override                    {}
+    void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override { buffer.applyGain (0.5f); }
+
+    double getTailLengthSeconds() const override        { return 0.0; }
+    bool acceptsMidi() const override                   { return false; }
+    bool producesMidi() const override                  { return false; }
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override                     { return false; }
+    int getNumPrograms() override                       { return 1; }
+    int getCurrentProgram() override                    { return 0; }
+    void setCurrentProgram (int) override               {}
+    const juce::String getProgramName (int) override    { return {}; }
+    void changeProgramName (int, const juce::String&) override {}
+    void getStateInformation (juce::MemoryBlock&) override {}
+    void setStateInformation (const void*, int) override {}
+
+    static constexpr const char* identifier = "internal:gain";
+};
+
+// ****************************************************************************
+static std::unique_ptr<juce::AudioPluginInstance> createInstance (juce::AudioPluginFormatManager& formats,
+                                                                  const juce::PluginDescription& description,
+                                                                  double sampleRate, int blockSize, juce::String& error) {
+
+    if (description.fileOrIdentifier == SandboxTestPlugin::identifier)
+        return std::make_unique<SandboxTestPlugin>();
+
+    auto instance = formats.createPluginInstance (description, sampleRate, blockSize, error);
+    if (instance == nullptr)
+        return nullptr;
+
+    auto layout = instance->getBusesLayout();
+    auto stereo = juce::AudioChannelSet::stereo();
+    layout.getChannelSet(true, 0)  = stereo;  // input
+    layout.getChannelSet(false, 0) = stereo;  // output
+    if (instance->checkBusesLayoutSupported(layout)) {
+        instance->setBusesLayout(layout);
+    }
+    return instance;
+}
+
+// ****************************************************************************
+juce::MemoryBlock PluginSandbox::toMessage (const juce::XmlElement& xml) {
+
+    auto text = xml.toString (juce::XmlElement::TextFormat().singleLine().withoutHeader());
+    return { text.toRawUTF8(), text.getNumBytesAsUTF8() };
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::XmlElement> PluginSandbox::fromMessage (const juce::MemoryBlock& message) {
+
+    return juce::parseXML (message.toString());
+}
+
+// ****************************************************************************
+juce::int64 PluginSandbox::getProcessCpuMicroseconds() {
+
+   #if JUCE_LINUX || JUCE_MAC
+    rusage usage {};
+    getrusage (RUSAGE_SELF, &usage);
+    return (juce::int64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+             + (juce::int64) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+   #else
+    return 0;
+   #endif
+}
+
+// ****************************************************************************
+PluginSandbox::ScanResult PluginSandbox::scanFile (const juce::String& formatName, const juce::String& fileOrIdentifier,
+                                                   juce::OwnedArray<juce::PluginDescription>& results) {
+
+    PluginSandboxConnection connection;
+    if (! connection.launch())
+        return ScanResult::unavailable;
+
+    juce::XmlElement scan ("scan");
+    scan.setAttribute ("format", formatName);
+    scan.setAttribute ("file", fileOrIdentifier);
+
+    // A plugin that hangs the probe gets killed along with the child when
+    //  the connection goes out of scope
+    auto reply = connection.request (scan, 30000);
+    if (reply == nullptr)
+        return ScanResult::failed;
+
+    for (auto* type : reply->getChildWithTagNameIterator ("PLUGIN")) {
+        auto description = std::make_unique<juce::PluginDescription>();
+        if (description->loadFromXml (*type))
+            results.add (description.release());
+    }
+    return ScanResult::ok;
+}
+
+// ****************************************************************************
+class PluginSandboxWorker::AudioThread final : public juce::Thread
+{
+public:
+    AudioThread (juce::AudioPluginInstance& p, SharedAudioRing& r)
+        : juce::Thread ("Sandbox audio"),
+          plugin (p),
+          ring (r) {
+
+        midi.ensureSize (2048);
+    }
+
+    void run() override {
+
+        juce::ScopedNoDenormals noDenormals;
+        std::array<float*, SharedAudioRing::maxChannels> channels {};
+        juce::AudioBuffer<float> view;
+
+        auto handled = ring.getLatestRequest();
+
+        while (! threadShouldExit() && ! ring.isShutdown()) {
+            if (! ring.waitForRequest (handled, 100000))
+                continue;
+
+            // Work through everything the host has queued, in order. The
+            //  plugin processes the shared slot in place.
+            for (const auto latest = ring.getLatestRequest(); handled != latest; ) {
+                ++handled;
+                for (int ch = 0; ch < ring.getNumChannels(); ++ch)
+                    channels[(size_t) ch] = ring.getChannel (handled, ch);
+
+                view.setDataToReferTo (channels.data(), ring.getNumChannels(), ring.getNumSamples (handled));
+                midi.clear();
+                plugin.processBlock (view, midi);
+                ring.submitResponse (handled);
+            }
+        }
+    }
+
+private:
+    juce::AudioPluginInstance& plugin;
+    SharedAudioRing& ring;
+    juce::MidiBuffer midi;
+};
+
+// ****************************************************************************
+PluginSandboxWorker::PluginSandboxWorker() {
+
+    addDefaultFormatsToManager (formatManager);
+}
+
+// ****************************************************************************
+PluginSandboxWorker::~PluginSandboxWorker() {
+
+    stopTimer();
+    stopAudio();
+    editorWindow = nullptr;
+    plugin.reset();
+}
+
+// ****************************************************************************
+void PluginSandboxWorker::handleMessageFromCoordinator (const juce::MemoryBlock& message) {
+
+    // Plugins expect to be created and driven from the message thread
+    std::shared_ptr<juce::XmlElement> xml (PluginSandbox::fromMessage (message));
+    if (xml != nullptr)
+        juce::MessageManager::callAsync ([this, xml] { handleMessage (*xml); });
+}
+
+// ****************************************************************************
+void PluginSandboxWorker::handleConnectionLost() {
+
+    juce::JUCEApplicationBase::quit();
+}
+
+// ****************************************************************************
+void PluginSandboxWorker::stopAudio() {
+
+    if (audioThread != nullptr) {
+        ring->requestShutdown();
+        audioThread->stopThread (2000);
+        audioThread = nullptr;
+    }
+    ring = nullptr;
+}
+
+// ****************************************************************************
+void PluginSandboxWorker::audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails& details) {
+
+    if (details.programChanged || details.nonParameterStateChanged)
+        stateChanged = true;
+}
+
+// ****************************************************************************
+void PluginSandboxWorker::timerCallback() {
+
+    // Changes are gathered up, so a knob being turned pushes a few states a
+    //  second rather than one per parameter update
+    if (plugin == nullptr || ! stateChanged.exchange (false))
+        return;
+
+    juce::MemoryBlock state;
+    plugin->getStateInformation (state);
+
+    juce::XmlElement push ("state");
+    push.setAttribute ("state", state.toBase64Encoding());
+    sendMessageToCoordinator (PluginSandbox::toMessage (push));
+}
+
+// ****************************************************************************
+void PluginSandboxWorker::handleMessage (const juce::XmlElement& message) {
+
+    juce::XmlElement reply ("reply");
+    reply.setAttribute ("id", message.getIntAttribute ("id"));
+
+    if (message.hasTagName ("scan")) {
+        for (auto* format : formatManager.getFormats()) {
+            if (format->getName() != message.getStringAttribute ("format"))
+                continue;
+
+            juce::OwnedArray<juce::PluginDescription> types;
+            format->findAllTypesForFile (types, message.getStringAttribute ("file"));
+            for (auto* type : types)
+                reply.addChildElement (type->createXml().release());
+        }
+    }
+    else if (message.hasTagName ("load")) {
+        stopAudio();
+        editorWindow = nullptr;
+        plugin.reset();
+
+        juce::PluginDescription description;
+        if (auto* xml = message.getChildByName ("PLUGIN"))
+            description.loadFromXml (*xml);
+
+        juce::String error;
+        plugin = createInstance (formatManager, description, message.getDoubleAttribute ("sampleRate"),
+                                 message.getIntAttribute ("blockSize"), error);
+        if (plugin == nullptr) {
+            reply.setAttribute ("error", error.isNotEmpty() ? error : juce::String ("Unable to load plugin"));
+        }
+        else {
+            reply.setAttribute ("latency", plugin->getLatencySamples());
+            reply.setAttribute ("tail", plugin->getTailLengthSeconds());
+
+            plugin->addListener (this);
+            stateChanged = true;
+            startTimer (statePushIntervalMs);
+        }
+    }
+    else if (message.hasTagName ("prepare")) {
+        stopAudio();
+        ring = SharedAudioRing::open (juce::File (message.getStringAttribute ("ring")));
+
+        if (plugin == nullptr || ring == nullptr) {
+            reply.setAttribute ("error", "Nothing to prepare");
+        }
+        else {
+            const auto sampleRate = message.getDoubleAttribute ("sampleRate");
+            const auto blockSize = message.getIntAttribute ("blockSize");
+            plugin->prepareToPlay (sampleRate, blockSize);
+
+            audioThread = std::make_unique<AudioThread> (*plugin, *ring);
+            if (! audioThread->startRealtimeThread (juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime (blockSize, sampleRate)))
+                audioThread->startThread (juce::Thread::Priority::highest);
+
+            reply.setAttribute ("latency", plugin->getLatencySamples());
+        }
+    }
+    else if (message.hasTagName ("release")) {
+        stopAudio();
+        if (plugin != nullptr)
+            plugin->releaseResources();
+    }
+    else if (message.hasTagName ("getState")) {
+        juce::MemoryBlock state;
+        if (plugin != nullptr)
+            plugin->getStateInformation (state);
+        reply.setAttribute ("state", state.toBase64Encoding());
+    }
+    else if (message.hasTagName ("setState")) {
+        juce::MemoryBlock state;
+        if (plugin != nullptr && state.fromBase64Encoding (message.getStringAttribute ("state"))) {
+            plugin->setStateInformation (state.getData(), (int) state.getSize());
+            stateChanged = true;
+        }
+    }
+    else if (message.hasTagName ("showEditor")) {
+        if (plugin != nullptr) {
+            if (editorWindow == nullptr)
+                editorWindow = std::make_unique<PluginWindow> (*plugin);
+            else
+                editorWindow->setVisible (true);
+            editorWindow->toFront (true);
+        }
+    }
+    else if (message.hasTagName ("stats")) {
+        reply.setAttribute ("cpu", juce::String (PluginSandbox::getProcessCpuMicroseconds()));
+    }
+
+    sendMessageToCoordinator (PluginSandbox::toMessage (reply));
+}
+
+// ****************************************************************************
+PluginSandboxConnection::~PluginSandboxConnection() {
+
+    killWorkerProcess();
+}
+
+// ****************************************************************************
+bool PluginSandboxConnection::launch() {
+
+    connected = launchWorkerProcess (juce::File::getSpecialLocation (juce::File::currentExecutableFile),
+                                     PluginSandbox::processUID, 0, 0);
+    return connected;
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::XmlElement> PluginSandboxConnection::request (juce::XmlElement message, int timeoutMs) {
+
+    const juce::ScopedLock sl (requestLock);
+
+    if (! connected)
+        return nullptr;
+
+    {
+        const juce::ScopedLock rl (replyLock);
+        expectedReplyId = ++nextRequestId;
+        reply = nullptr;
+    }
+
+    message.setAttribute ("id", expectedReplyId);
+    replyArrived.reset();
+
+    if (! sendMessageToWorker (PluginSandbox::toMessage (message)))
+        return nullptr;
+
+    replyArrived.wait (timeoutMs);
+
+    const juce::ScopedLock rl (replyLock);
+    expectedReplyId = -1;
+    return std::move (reply);
+}
+
+// ****************************************************************************
+void PluginSandboxConnection::handleMessageFromWorker (const juce::MemoryBlock& message) {
+
+    auto xml = PluginSandbox::fromMessage (message);
+    if (xml == nullptr)
+        return;
+
+    const juce::ScopedLock rl (replyLock);
+
+    if (xml->hasTagName ("state")) {
+        pushedState.fromBase64Encoding (xml->getStringAttribute ("state"));
+        return;
+    }
+
+    if (xml->getIntAttribute ("id") == expectedReplyId) {
+        reply = std::move (xml);
+        replyArrived.signal();
+    }
+}
+
+// ****************************************************************************
+juce::MemoryBlock PluginSandboxConnection::getPushedState() const {
+
+    const juce::ScopedLock rl (replyLock);
+    return pushedState;
+}
+
+// ****************************************************************************
+void PluginSandboxConnection::handleConnectionLost() {
+
+    connected = false;
+    replyArrived.signal();
+}
+
+// ****************************************************************************
+SandboxedPlugin::SandboxedPlugin (const juce::PluginDescription& d, std::unique_ptr<PluginSandboxConnection> c)
+    : AudioPluginInstance (BusesProperties().withInput  ("Input",  juce::AudioChannelSet::stereo())
+                                            .withOutput ("Output", juce::AudioChannelSet::stereo())),
+      description (d),
+      connection (std::move (c)) {
+}
+
+// ****************************************************************************
+SandboxedPlugin::~SandboxedPlugin() {
+
+    ringReady = false;
+    connection = nullptr;       // kills the child
+    ring = nullptr;
+    ringFile.deleteFile();
+}
+
+// ****************************************************************************
+std::unique_ptr<SandboxedPlugin> SandboxedPlugin::create (const juce::PluginDescription& description,
+                                                          double sampleRate, int blockSize, juce::String& error) {
+
+    auto connection = std::make_unique<PluginSandboxConnection>();
+    if (! connection->launch()) {
+        error = "Unable to launch the plugin sandbox";
+        return nullptr;
+    }
+
+    juce::XmlElement load ("load");
+    load.setAttribute ("sampleRate", sampleRate);
+    load.setAttribute ("blockSize", blockSize);
+    if (auto xml = description.createXml())
+        load.addChildElement (xml.release());
+
+    auto reply = connection->request (load, 30000);
+    if (reply == nullptr) {
+        error = "The plugin sandbox did not respond";
+        return nullptr;
+    }
+    if (reply->hasAttribute ("error")) {
+        error = reply->getStringAttribute ("error");
+        return nullptr;
+    }
+
+    std::unique_ptr<SandboxedPlugin> plugin (new SandboxedPlugin (description, std::move (connection)));
+    plugin->setLatencySamples (reply->getIntAttribute ("latency"));
+    plugin->tailLengthSeconds = reply->getDoubleAttribute ("tail");
+    return plugin;
+}
+
+// ****************************************************************************
+void SandboxedPlugin::prepareToPlay (double sampleRate, int samplesPerBlock) {
+
+    // Start every prepare on a fresh ring so no sequence numbers or shutdown
+    //  flags from the previous run leak into this one
+    ringReady = false;
+    ring = nullptr;
+    ringFile.deleteFile();
+
+    ringFile = SharedAudioRing::createBackingFile();
+    ring = SharedAudioRing::create (ringFile, samplesPerBlock,
+                                    juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    if (ring == nullptr)
+        return;
+
+    juce::XmlElement prepare ("prepare");
+    prepare.setAttribute ("sampleRate", sampleRate);
+    prepare.setAttribute ("blockSize", samplesPerBlock);
+    prepare.setAttribute ("ring", ringFile.getFullPathName());
+
+    auto reply = connection->request (prepare, requestTimeoutMs);
+    if (reply == nullptr || reply->hasAttribute ("error"))
+        return;
+
+    // Waiting a full block for the child would leave nothing of the period
+    //  for the rest of the board, so only a quarter of it is spent
+    nextSequence = 0;
+    runningLate = false;
+    blocksSinceProbe = 0;
+    responseTimeoutMicroseconds = juce::jlimit (100, 1000, (int) (0.25e6 * samplesPerBlock / sampleRate));
+    ringReady = true;
+}
+
+// ****************************************************************************
+void SandboxedPlugin::releaseResources() {
+
+    ringReady = false;
+    connection->request (juce::XmlElement ("release"), requestTimeoutMs);
+}
+
+// ****************************************************************************
+void SandboxedPlugin::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+
+    const int numSamples = buffer.getNumSamples();
+
+    // A dead or unprepared sandbox passes the block through dry
+    if (! ringReady.load (std::memory_order_acquire) || ! connection->isConnected()
+         || numSamples > ring->getMaxBlockSize())
+        return;
+
+    const int numChannels = juce::jmin (buffer.getNumChannels(), ring->getNumChannels());
+    const auto sequence = ++nextSequence;
+
+    if (! runningLate) {
+        for (int ch = 0; ch < ring->getNumChannels(); ++ch) {
+            if (ch < numChannels)
+                juce::FloatVectorOperations::copy (ring->getChannel (sequence, ch), buffer.getReadPointer (ch), numSamples);
+            else
+                juce::FloatVectorOperations::clear (ring->getChannel (sequence, ch), numSamples);
+        }
+
+        ring->submitRequest (sequence, numSamples);
+
+        if (ring->waitForResponse (sequence, responseTimeoutMicroseconds)) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::copy (buffer.getWritePointer (ch), ring->getChannel (sequence, ch), numSamples);
+            return;
+        }
+
+        // Too slow to come back within the block, so from now on each block
+        //  returns the one before, which has had a whole period to finish.
+        //  This one repeats the last block the child gave back, which is
+        //  still in its slot, so the late output joins on without a seam.
+        runningLate = true;
+        blocksSinceProbe = 0;
+        lateBlocks.fetch_add (1, std::memory_order_relaxed);
+        if (sequence > 1) {
+            const int span = juce::jmin (numSamples, ring->getNumSamples (sequence - 1));
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::copy (buffer.getWritePointer (ch), ring->getChannel (sequence - 1, ch), span);
+        }
+        return;
+    }
+
+    // Never more than two blocks in flight, so the child's slots aren't overwritten
+    const auto previous = sequence - 1;
+    if (! ring->waitForResponse (previous, responseTimeoutMicroseconds)) {
+        --nextSequence;
+        lateBlocks.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    const int span = juce::jmin (numSamples, ring->getNumSamples (previous));
+
+    // Every so often see whether the child keeps up again, by waiting for
+    //  this block as well. If it's back in time the output fades from the
+    //  block it still owed into this one and we carry on in step; if not,
+    //  this block just stays in flight as usual.
+    if (++blocksSinceProbe >= resyncProbeInterval) {
+        blocksSinceProbe = 0;
+
+        for (int ch = 0; ch < ring->getNumChannels(); ++ch) {
+            if (ch < numChannels)
+                juce::FloatVectorOperations::copy (ring->getChannel (sequence, ch), buffer.getReadPointer (ch), numSamples);
+            else
+                juce::FloatVectorOperations::clear (ring->getChannel (sequence, ch), numSamples);
+        }
+
+        ring->submitRequest (sequence, numSamples);
+
+        const bool inTime = ring->waitForResponse (sequence, responseTimeoutMicroseconds);
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto* io = buffer.getWritePointer (ch);
+            const auto* done = ring->getChannel (previous, ch);
+            if (! inTime) {
+                juce::FloatVectorOperations::copy (io, done, span);
+                continue;
+            }
+
+            const auto* now = ring->getChannel (sequence, ch);
+            for (int i = 0; i < span; ++i)
+                io[i] = done[i] + (now[i] - done[i]) * (float) (i + 1) / (float) span;
+            juce::FloatVectorOperations::copy (io + span, now + span, numSamples - span);
+        }
+
+        runningLate = ! inTime;
+        return;
+    }
+
+    // This block goes into its slot and the previous one comes out of the
+    //  ring in a single pass over the buffer
+    for (int ch = 0; ch < ring->getNumChannels(); ++ch) {
+        auto* next = ring->getChannel (sequence, ch);
+        if (ch >= numChannels) {
+            juce::FloatVectorOperations::clear (next, numSamples);
+            continue;
+        }
+
+        auto* io = buffer.getWritePointer (ch);
+        const auto* done = ring->getChannel (previous, ch);
+        for (int i = 0; i < span; ++i) {
+            next[i] = io[i];
+            io[i] = done[i];
+        }
+        juce::FloatVectorOperations::copy (next + span, io + span, numSamples - span);
+    }
+
+    ring->submitRequest (sequence, numSamples);
+}
+
+// ****************************************************************************
+void SandboxedPlugin::getStateInformation (juce::MemoryBlock& destData) {
+
+    if (auto reply = connection->request (juce::XmlElement ("getState"), requestTimeoutMs))
+        destData.fromBase64Encoding (reply->getStringAttribute ("state"));
+}
+
+// ****************************************************************************
+void SandboxedPlugin::setStateInformation (const void* data, int sizeInBytes) {
+
+    juce::XmlElement setState ("setState");
+    setState.setAttribute ("state", juce::MemoryBlock (data, (size_t) sizeInBytes).toBase64Encoding());
+    connection->request (setState, requestTimeoutMs);
+}
+
+// ****************************************************************************
+void SandboxedPlugin::showEditorWindow() {
+
+    connection->request (juce::XmlElement ("showEditor"), requestTimeoutMs);
+}
+
+// ****************************************************************************
+juce::int64 SandboxedPlugin::getSandboxCpuMicroseconds() {
+
+    if (auto reply = connection->request (juce::XmlElement ("stats"), requestTimeoutMs))
+        return reply->getStringAttribute ("cpu").getLargeIntValue();
+    return -1;
+}
+
+// ****************************************************************************
+struct BenchmarkResult
+{
+    std::vector<double> blockMicroseconds;
+    double hostCpuPercent = 0.0;
+    double sandboxCpuPercent = 0.0;
+
+    double percentile (double p) const {
+
+        auto sorted = blockMicroseconds;
+        std::sort (sorted.begin(), sorted.end());
+        return sorted[(size_t) juce::jlimit (0, (int) sorted.size() - 1, (int) (p * (double) sorted.size()))];
+    }
+};
+
+// ****************************************************************************
+static BenchmarkResult benchmarkPlugin (juce::AudioPluginInstance& plugin, double sampleRate, int blockSize,
+                                        int numBlocks, SandboxedPlugin* sandboxed) {
+
+    plugin.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random;
+
+    auto fill = [&] {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample (ch, i, random.nextFloat() * 0.2f - 0.1f);
+    };
+
+    for (int i = 0; i < 200; ++i) {
+        fill();
+        plugin.processBlock (buffer, midi);
+    }
+
+    BenchmarkResult result;
+    result.blockMicroseconds.reserve ((size_t) numBlocks);
+
+    const auto hostCpuStart = PluginSandbox::getProcessCpuMicroseconds();
+    const auto sandboxCpuStart = sandboxed != nullptr ? sandboxed->getSandboxCpuMicroseconds() : 0;
+    const auto ticksPerMicrosecond = (double) juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+
+    for (int i = 0; i < numBlocks; ++i) {
+        fill();
+        const auto start = juce::Time::getHighResolutionTicks();
+        plugin.processBlock (buffer, midi);
+        result.blockMicroseconds.push_back ((double) (juce::Time::getHighResolutionTicks() - start) / ticksPerMicrosecond);
+    }
+
+    // CPU as a share of the audio time we pushed through
+    const auto audioMicroseconds = 1.0e6 * numBlocks * blockSize / sampleRate;
+    result.hostCpuPercent = 100.0 * (double) (PluginSandbox::getProcessCpuMicroseconds() - hostCpuStart) / audioMicroseconds;
+    if (sandboxed != nullptr)
+        result.sandboxCpuPercent = 100.0 * (double) (sandboxed->getSandboxCpuMicroseconds() - sandboxCpuStart) / audioMicroseconds;
+
+    plugin.releaseResources();
+    return result;
+}
+
+// ****************************************************************************
+int PluginSandbox::runBenchmark (const juce::StringArray& args) {
+
+    juce::AudioPluginFormatManager formatManager;
+    addDefaultFormatsToManager (formatManager);
+
+    auto description = SandboxTestPlugin::getDescription();
+
+    const auto argIndex = args.indexOf ("--sandbox-bench");
+    if (argIndex >= 0 && argIndex + 1 < args.size()) {
+        const auto file = args[argIndex + 1].unquoted();
+
+        juce::OwnedArray<juce::PluginDescription> types;
+        for (auto* format : formatManager.getFormats())
+            format->findAllTypesForFile (types, file);
+
+        if (types.isEmpty()) {
+            juce::Logger::writeToLog ("No plugin found in " + file);
+            return 1;
+        }
+        description = *types[0];
+    }
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int numBlocks = 5000;
+
+    juce::Logger::writeToLog ("Sandbox benchmark: " + description.name + " at " + juce::String (sampleRate, 0) + " Hz, "
+                              + juce::String (numBlocks) + " blocks back to back");
+
+    for (auto blockSize : { 32, 64, 128, 256, 512 }) {
+        juce::String error;
+        auto local = createInstance (formatManager, description, sampleRate, blockSize, error);
+        auto sandboxed = SandboxedPlugin::create (description, sampleRate, blockSize, error);
+        if (local == nullptr || sandboxed == nullptr) {
+            juce::Logger::writeToLog ("Unable to create plugin: " + error);
+            return 1;
+        }
+
+        auto inProcess = benchmarkPlugin (*local, sampleRate, blockSize, numBlocks, nullptr);
+        auto outOfProcess = benchmarkPlugin (*sandboxed, sampleRate, blockSize, numBlocks, sandboxed.get());
+
+        auto describe = [] (const BenchmarkResult& r) {
+            return "p50 " + juce::String (r.percentile (0.5), 1) + " us, p99 " + juce::String (r.percentile (0.99), 1)
+                   + " us, max " + juce::String (r.percentile (1.0), 1) + " us";
+        };
+
+        juce::Logger::writeToLog ("block " + juce::String (blockSize).paddedLeft (' ', 4)
+                                  + " | in-process " + describe (inProcess)
+                                  + ", cpu " + juce::String (inProcess.hostCpuPercent, 2) + "%"
+                                  + " | sandboxed " + describe (outOfProcess)
+                                  + ", host cpu " + juce::String (outOfProcess.hostCpuPercent, 2) + "%"
+                                  + ", child cpu " + juce::String (outOfProcess.sandboxCpuPercent, 2) + "%"
+                                  + ", late blocks " + juce::String (sandboxed->getNumLateBlocks()));
+    }
+
+    return 0;
+}
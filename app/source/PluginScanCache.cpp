@@ -0,0 +1,237 @@
+// ****************************************************************************
+//     Filename: PluginScanCache.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Persistent plugin scan cache module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "PluginScanCache.h"
+#include "PluginSandbox.h"
+
+// ****************************************************************************
+PluginScanCache::PluginScanCache (juce::AudioPluginFormatManager& formats, const juce::File& file)
+    : juce::Thread ("Plugin scanner"),
+      formatManager (formats),
+      cacheFile (file),
+      probePool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1)) {
+}
+
+// ****************************************************************************
+PluginScanCache::~PluginScanCache() {
+
+    signalThreadShouldExit();
+    probePool.removeAllJobs (true, 5000);
+    stopThread (10000);
+}
+
+// ****************************************************************************
+juce::File PluginScanCache::getDefaultCacheFile() {
+
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("MoodBoard")
+               .getChildFile ("PluginCache.xml");
+}
+
+// ****************************************************************************
+void PluginScanCache::startScan (std::function<void()> onFinished) {
+
+    if (isThreadRunning())
+        return;
+
+    scanFinished = std::move (onFinished);
+    startThread (juce::Thread::Priority::background);
+}
+
+// ****************************************************************************
+std::unique_ptr<juce::PluginDescription> PluginScanCache::findPlugin (const juce::String& name) const {
+
+    for (auto& type : knownPlugins.getTypes())
+        if (type.name.equalsIgnoreCase (name))
+            return std::make_unique<juce::PluginDescription> (type);
+    return nullptr;
+}
+
+// ****************************************************************************
+PluginScanCache::FileStamp PluginScanCache::stampFor (const juce::String& fileOrIdentifier) {
+
+    juce::File file (fileOrIdentifier);
+    if (! file.isDirectory())
+        return { file.getSize(), file.getLastModificationTime().toMilliseconds() };
+
+    // Bundles (VST3, AU) are directories whose own size is 0 and whose mtime
+    //  rarely moves when the binary inside is replaced, so they're stamped by
+    //  the total size and newest mtime of everything under Contents
+    auto contents = file.getChildFile ("Contents");
+    if (! contents.isDirectory())
+        contents = file;
+
+    FileStamp stamp { 0, file.getLastModificationTime().toMilliseconds() };
+    for (auto& child : contents.findChildFiles (juce::File::findFiles, true)) {
+        stamp.size += child.getSize();
+        stamp.modificationTime = juce::jmax (stamp.modificationTime, child.getLastModificationTime().toMilliseconds());
+    }
+    return stamp;
+}
+
+// ****************************************************************************
+void PluginScanCache::run() {
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    loadCache();
+
+    int numProbed = 0;
+    int numRemoved = 0;
+
+    for (auto* format : formatManager.getFormats()) {
+        if (threadShouldExit())
+            return;
+
+        auto files = format->searchPathsForPlugins (format->getDefaultLocationsToSearch(), true, false);
+
+        // Anything we knew about that has since been removed
+        std::vector<juce::String> missing;
+        {
+            const juce::ScopedLock sl (stampLock);
+            for (auto& [path, stamp] : stamps)
+                if (! files.contains (path) && ! juce::File (path).exists())
+                    missing.push_back (path);
+        }
+        for (auto& path : missing)
+            forgetFile (path);
+        numRemoved += (int) missing.size();
+
+        for (auto& path : files) {
+            const auto stamp = stampFor (path);
+            {
+                const juce::ScopedLock sl (stampLock);
+                auto known = stamps.find (path);
+                if (known != stamps.end() && known->second == stamp)
+                    continue;
+            }
+
+            forgetFile (path);
+            ++numProbed;
+            probePool.addJob ([this, format, path] { probeFile (*format, path); });
+        }
+    }
+
+    while (probePool.getNumJobs() > 0) {
+        if (threadShouldExit())
+            return;
+        wait (20);
+    }
+
+    if (numProbed > 0 || numRemoved > 0)
+        saveCache();
+
+    juce::Logger::writeToLog ("Plugin scan: " + juce::String (knownPlugins.getNumTypes()) + " plugins, "
+                              + juce::String (numProbed) + " probed in "
+                              + juce::String (juce::Time::getMillisecondCounterHiRes() - startTime, 1) + " ms");
+
+    if (scanFinished != nullptr)
+        juce::MessageManager::callAsync (scanFinished);
+}
+
+// ****************************************************************************
+void PluginScanCache::probeFile (juce::AudioPluginFormat& format, const juce::String& fileOrIdentifier) {
+
+    juce::OwnedArray<juce::PluginDescription> types;
+    auto result = PluginSandbox::ScanResult::unavailable;
+
+    if (scanOutOfProcess)
+        result = PluginSandbox::scanFile (format.getName(), fileOrIdentifier, types);
+
+    if (result == PluginSandbox::ScanResult::unavailable)
+        format.findAllTypesForFile (types, fileOrIdentifier);
+
+    if (types.isEmpty())
+        knownPlugins.addToBlacklist (fileOrIdentifier);
+
+    for (auto* type : types)
+        knownPlugins.addType (*type);
+
+    const juce::ScopedLock sl (stampLock);
+    stamps[fileOrIdentifier] = stampFor (fileOrIdentifier);
+}
+
+// ****************************************************************************
+void PluginScanCache::forgetFile (const juce::String& fileOrIdentifier) {
+
+    for (auto& type : knownPlugins.getTypes())
+        if (type.fileOrIdentifier == fileOrIdentifier)
+            knownPlugins.removeType (type);
+
+    knownPlugins.removeFromBlacklist (fileOrIdentifier);
+
+    const juce::ScopedLock sl (stampLock);
+    stamps.erase (fileOrIdentifier);
+}
+
+// ****************************************************************************
+void PluginScanCache::loadCache() {
+
+    auto xml = juce::parseXML (cacheFile);
+    if (xml == nullptr || ! xml->hasTagName ("PLUGINCACHE"))
+        return;
+
+    if (auto* list = xml->getChildByName ("KNOWNPLUGINS"))
+        knownPlugins.recreateFromXml (*list);
+
+    const juce::ScopedLock sl (stampLock);
+    if (auto* files = xml->getChildByName ("STAMPS")) {
+        for (auto* file : files->getChildWithTagNameIterator ("FILE")) {
+            stamps[file->getStringAttribute ("path")] = { file->getStringAttribute ("size").getLargeIntValue(),
+                                                          file->getStringAttribute ("mtime").getLargeIntValue() };
+        }
+    }
+}
+
+// ****************************************************************************
+void PluginScanCache::saveCache() {
+
+    juce::XmlElement xml ("PLUGINCACHE");
+
+    if (auto list = knownPlugins.createXml())
+        xml.addChildElement (list.release());
+
+    auto* files = xml.createNewChildElement ("STAMPS");
+    {
+        const juce::ScopedLock sl (stampLock);
+        for (auto& [path, stamp] : stamps) {
+            auto* file = files->createNewChildElement ("FILE");
+            file->setAttribute ("path", path);
+            file->setAttribute ("size", juce::String (stamp.size));
+            file->setAttribute ("mtime", juce::String (stamp.modificationTime));
+        }
+    }
+
+    cacheFile.getParentDirectory().createDirectory();
+    if (! xml.writeTo (cacheFile))
+        DBG ("Unable to write plugin cache " << cacheFile.getFullPathName());
+}
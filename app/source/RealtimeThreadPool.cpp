@@ -0,0 +1,240 @@
+// ****************************************************************************
+//     Filename: RealtimeThreadPool.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Real-time worker pool module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "RealtimeThreadPool.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+// ****************************************************************************
+class RealtimeThreadPool::Worker final : public juce::Thread
+{
+public:
+    Worker (RealtimeThreadPool& p, int index, int cpu, int priority)
+        : juce::Thread ("MoodBoard worker " + juce::String (index)),
+          pool (p),
+          core (cpu),
+          fifoPriority (priority) {
+    }
+
+    void run() override {
+
+        // Set once for the life of the thread, the tasks never touch it
+        juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+
+        if (core >= 0 && pinCurrentThread (core))
+            pool.numPinned.fetch_add (1);
+        if (fifoPriority > 0 && setCurrentThreadFifo (fifoPriority))
+            pool.numFifo.fetch_add (1);
+        if (fifoPriority > 0)
+            prefaultStack();
+
+        auto observed = pool.work.load (std::memory_order_acquire);
+
+        while (! pool.shuttingDown.load (std::memory_order_acquire)) {
+            if (pool.runOneTask (observed))
+                continue;
+
+            pool.waitForWork (observed);
+            observed = pool.work.load (std::memory_order_acquire);
+        }
+    }
+
+private:
+    RealtimeThreadPool& pool;
+    const int core;
+    const int fifoPriority;
+};
+
+// ****************************************************************************
+RealtimeThreadPool::RealtimeThreadPool (int numWorkers, double sampleRate, int blockSize,
+                                        const juce::Array<int>& cores, int fifoPriority) {
+
+    auto options = juce::Thread::RealtimeOptions{}
+                       .withApproximateAudioProcessingTime (blockSize, sampleRate);
+
+    for (int i = 0; i < juce::jlimit (0, maxWorkers, numWorkers); ++i) {
+        auto* worker = workers.add (new Worker (*this, i, i < cores.size() ? cores[i] : -1, fifoPriority));
+
+        // Fall back to a normal high priority thread if the OS refuses us
+        if (! worker->startRealtimeThread (options))
+            worker->startThread (juce::Thread::Priority::highest);
+    }
+}
+
+// ****************************************************************************
+RealtimeThreadPool::~RealtimeThreadPool() {
+
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    shuttingDown.store (true, std::memory_order_release);
+    work.store (makeWork (generationOf (work.load()) + 1, 0), std::memory_order_release);
+    work.notify_all();
+
+    for (auto* worker : workers)
+        worker->stopThread (1000);
+}
+
+// ****************************************************************************
+int RealtimeThreadPool::getDefaultNumWorkers() {
+
+    return juce::jlimit (0, maxWorkers, juce::SystemStats::getNumPhysicalCpus() - 2);
+}
+
+// ****************************************************************************
+bool RealtimeThreadPool::pinCurrentThread (int core) {
+
+   #if JUCE_LINUX
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    CPU_SET (core, &set);
+    return pthread_setaffinity_np (pthread_self(), sizeof (set), &set) == 0;
+   #else
+    juce::ignoreUnused (core);
+    return false;
+   #endif
+}
+
+// ****************************************************************************
+bool RealtimeThreadPool::setCurrentThreadFifo (int priority) {
+
+   #if JUCE_LINUX
+    sched_param param {};
+    param.sched_priority = juce::jlimit (sched_get_priority_min (SCHED_FIFO), sched_get_priority_max (SCHED_FIFO), priority);
+    return pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) == 0;
+   #else
+    juce::ignoreUnused (priority);
+    return false;
+   #endif
+}
+
+// ****************************************************************************
+void RealtimeThreadPool::prefaultStack() {
+
+    // One write per page is enough to fault it in
+    char stack[stackBytes];
+    auto* bytes = static_cast<volatile char*> (stack);
+    for (size_t i = 0; i < stackBytes; i += 4096)
+        bytes[i] = 0;
+}
+
+// ****************************************************************************
+void RealtimeThreadPool::cpuRelax() noexcept {
+
+   #if JUCE_INTEL
+    _mm_pause();
+   #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+    __asm__ __volatile__ ("yield");
+   #endif
+}
+
+// ****************************************************************************
+bool RealtimeThreadPool::runOneTask (uint64_t& observedWork) {
+
+    for (;;) {
+        const auto next = nextTaskOf (observedWork);
+        if (next >= numTasksOf (observedWork))
+            return false;
+
+        if (work.compare_exchange_weak (observedWork, observedWork + 1,
+                                        std::memory_order_acq_rel, std::memory_order_acquire))
+            break;
+    }
+
+    // Our claim holds this batch open, so the function and context can't have
+    //  been replaced by the next run() yet.
+    const auto claimed = nextTaskOf (observedWork);
+    observedWork += 1;
+
+    currentFunction.load (std::memory_order_relaxed) (currentContext.load (std::memory_order_relaxed), claimed);
+
+    if (tasksRemaining.fetch_sub (1, std::memory_order_acq_rel) == 1)
+        tasksRemaining.notify_one();
+
+    return true;
+}
+
+// ****************************************************************************
+void RealtimeThreadPool::waitForWork (uint64_t observedWork) const {
+
+    for (int i = 0; i < spinIterations; ++i) {
+        if (work.load (std::memory_order_acquire) != observedWork)
+            return;
+        cpuRelax();
+    }
+
+    work.wait (observedWork, std::memory_order_acquire);
+}
+
+// ****************************************************************************
+void RealtimeThreadPool::run (int numTasks, TaskFunction taskFunction, void* context) {
+
+    jassert (numTasks <= maxTasks);
+
+    if (workers.isEmpty() || numTasks <= 1) {
+        for (int i = 0; i < numTasks; ++i)
+            taskFunction (context, i);
+        return;
+    }
+
+    currentFunction.store (taskFunction, std::memory_order_relaxed);
+    currentContext.store (context, std::memory_order_relaxed);
+    tasksRemaining.store (numTasks, std::memory_order_relaxed);
+
+    auto batch = makeWork (generationOf (work.load (std::memory_order_relaxed)) + 1, numTasks);
+    work.store (batch, std::memory_order_release);
+    work.notify_all();
+
+    // Help out rather than sit idle
+    while (runOneTask (batch)) {
+    }
+
+    // Barrier: spin first, since the other branches usually finish within
+    //  a few microseconds of ours, and only then sleep on the futex
+    for (int i = 0; i < spinIterations; ++i) {
+        if (tasksRemaining.load (std::memory_order_acquire) == 0)
+            return;
+        cpuRelax();
+    }
+
+    for (auto remaining = tasksRemaining.load (std::memory_order_acquire); remaining != 0;
+         remaining = tasksRemaining.load (std::memory_order_acquire))
+        tasksRemaining.wait (remaining, std::memory_order_acquire);
+}
@@ -0,0 +1,374 @@
+// ****************************************************************************
+//     Filename: SceneCache.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Preloaded board scene cache module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "SceneCache.h"
+#include "PluginSandbox.h"
+
+// ****************************************************************************
+SceneCache::SceneCache (SignalGraph& graph, PluginLoader& loader)
+    : signalGraph (graph),
+      pluginLoader (loader) {
+
+    // Whatever the graph already holds is live, so it starts out warm
+    for (int i = 0; i < signalGraph.getNumScenes(); ++i) {
+        SceneRecord record;
+        record.name = signalGraph.getScene (i).name;
+        record.warm = true;
+        records.push_back (std::move (record));
+    }
+
+    if (signalGraph.getNumScenes() > 0)
+        savedScene = &signalGraph.getScene (signalGraph.getCurrentScene());
+}
+
+// ****************************************************************************
+int SceneCache::storeCurrentScene (const juce::String& name) {
+
+    const auto current = signalGraph.getCurrentScene();
+    captureScene (current);
+
+    SceneRecord record;
+    record.name = name;
+    record.plugins = records[(size_t) current].plugins;
+    record.lastUsed = ++useCounter;
+
+    const auto index = signalGraph.addScene (name, signalGraph.getTopology());
+    jassert (index == (int) records.size());
+    records.push_back (std::move (record));
+
+    // Instantiating copies takes a while, but the running board is untouched
+    unsavedChanges = true;
+    warmScene (index);
+    return index;
+}
+
+// ****************************************************************************
+static void readState (juce::AudioPluginInstance& plugin, juce::MemoryBlock& state) {
+
+    // Asking a sandbox would block on its pipe, but the child pushes its state
+    //  whenever it changes, so the latest copy is already here
+    if (auto* sandboxed = dynamic_cast<SandboxedPlugin*> (&plugin))
+        sandboxed->getPushedState (state);
+    else
+        plugin.getStateInformation (state);
+}
+
+// ****************************************************************************
+void SceneCache::captureScene (int index) {
+
+    auto& record = records[(size_t) index];
+    if (! record.warm)
+        return;
+
+    const auto numSlots = (int) signalGraph.getScene (index).slots.size();
+    for (int i = 0; i < numSlots; ++i)
+        captureSlot (index, i);
+
+    std::sort (record.plugins.begin(), record.plugins.end(),
+               [] (const SlotRecipe& a, const SlotRecipe& b) { return a.slot < b.slot; });
+}
+
+// ****************************************************************************
+void SceneCache::captureSlot (int index, int slot) {
+
+    auto& plugins = records[(size_t) index].plugins;
+    auto* plugin = signalGraph.getScene (index).slots[(size_t) slot].plugin.get();
+    auto existing = std::find_if (plugins.begin(), plugins.end(), [slot] (const SlotRecipe& r) { return r.slot == slot; });
+
+    if (plugin == nullptr) {
+        if (existing != plugins.end()) {
+            plugins.erase (existing);
+            unsavedChanges = true;
+        }
+        return;
+    }
+
+    SlotRecipe recipe;
+    recipe.slot = slot;
+    plugin->fillInPluginDescription (recipe.description);
+    readState (*plugin, recipe.state);
+    recipe.outOfProcess = dynamic_cast<SandboxedPlugin*> (plugin) != nullptr;
+
+    if (existing == plugins.end()) {
+        plugins.push_back (std::move (recipe));
+        unsavedChanges = true;
+        return;
+    }
+
+    // States still in a board file are compared against the file
+    juce::MemoryBlock previous;
+    existing->getState (previous);
+    if (previous == recipe.state && existing->outOfProcess == recipe.outOfProcess
+         && existing->description.createIdentifierString() == recipe.description.createIdentifierString())
+        return;
+
+    *existing = std::move (recipe);
+    unsavedChanges = true;
+}
+
+// ****************************************************************************
+void SceneCache::captureNextSlot() {
+
+    if (nextCaptureScene >= (int) records.size()) {
+        nextCaptureScene = 0;
+        nextCaptureSlot = 0;
+        if (records.empty())
+            return;
+    }
+
+    // A scene still loading has nothing settled to capture yet
+    const auto& record = records[(size_t) nextCaptureScene];
+    const auto numSlots = (int) signalGraph.getScene (nextCaptureScene).slots.size();
+    if (record.warm && ! record.discarded && record.pendingLoads == 0 && nextCaptureSlot < numSlots) {
+        captureSlot (nextCaptureScene, nextCaptureSlot++);
+        return;
+    }
+
+    ++nextCaptureScene;
+    nextCaptureSlot = 0;
+}
+
+// ****************************************************************************
+bool SceneCache::hasUnsavedChanges() const {
+
+    // Moving to another scene counts too, once any recall has landed
+    for (auto& record : records)
+        if (record.recallWhenWarm)
+            return unsavedChanges;
+
+    return unsavedChanges || &signalGraph.getScene (signalGraph.getCurrentScene()) != savedScene;
+}
+
+// ****************************************************************************
+void SceneCache::recallScene (int index) {
+
+    if (! juce::isPositiveAndBelow (index, (int) records.size()))
+        return;
+
+    auto& record = records[(size_t) index];
+    if (record.discarded)
+        return;
+
+    record.lastUsed = ++useCounter;
+
+    // The latest recall wins over any scene still loading
+    for (auto& r : records)
+        r.recallWhenWarm = false;
+
+    if (! record.warm) {
+        record.recallWhenWarm = true;
+        if (record.pendingLoads == 0)
+            warmScene (index);
+        return;
+    }
+
+    signalGraph.selectScene (index);
+}
+
+// ****************************************************************************
+void SceneCache::warmScene (int index) {
+
+    auto& record = records[(size_t) index];
+    record.pendingLoads = (int) record.plugins.size();
+
+    if (record.pendingLoads == 0) {
+        sceneLoaded (index);
+        return;
+    }
+
+    for (auto& plugin : record.plugins) {
+        // Board states come straight out of the mapped file, and only for
+        //  the scenes that get loaded
+        juce::MemoryBlock state;
+        plugin.getState (state);
+
+        pluginLoader.load (plugin.description, state,
+                           signalGraph.getSampleRate(), signalGraph.getMaxBlockSize(), plugin.outOfProcess,
+        [safe = juce::WeakReference<SceneCache> (this), scene = &signalGraph.getScene (index),
+         slot = plugin.slot, generation = record.generation]
+        (std::unique_ptr<juce::AudioPluginInstance> instance, const juce::String& error)
+        {
+            if (safe == nullptr)
+                return;
+
+            // The scene may have moved or gone while we were loading
+            const auto i = safe->indexOf (scene);
+            if (i < 0 || safe->records[(size_t) i].generation != generation)
+                return;
+
+            auto& r = safe->records[(size_t) i];
+            if (instance == nullptr) {
+                juce::Logger::writeToLog ("Scene " + r.name + ": " + error);
+            }
+            else if (juce::isPositiveAndBelow (slot, (int) safe->signalGraph.getScene (i).slots.size())) {
+                // A scene being warmed is never selected, so it must be idle
+                const auto installed = safe->signalGraph.setScenePlugin (i, slot, std::move (instance));
+                jassert (installed);
+                juce::ignoreUnused (installed);
+            }
+
+            if (--r.pendingLoads == 0)
+                safe->sceneLoaded (i);
+        });
+    }
+}
+
+// ****************************************************************************
+void SceneCache::sceneLoaded (int index) {
+
+    auto& record = records[(size_t) index];
+    record.warm = true;
+
+    if (record.recallWhenWarm)
+        recallScene (index);
+    else
+        collectGarbage();
+}
+
+// ****************************************************************************
+int SceneCache::indexOf (const BoardScene* scene) const {
+
+    for (int i = 0; i < signalGraph.getNumScenes(); ++i)
+        if (&signalGraph.getScene (i) == scene)
+            return i;
+    return -1;
+}
+
+// ****************************************************************************
+void SceneCache::loadBoard (std::vector<SceneRecipe> scenes, int currentScene) {
+
+    if (scenes.empty())
+        return;
+
+    for (auto& record : records) {
+        record.discarded = true;
+        record.recallWhenWarm = false;
+        ++record.generation;
+    }
+
+    const auto first = (int) records.size();
+    for (auto& scene : scenes) {
+        const auto index = signalGraph.addScene (scene.name, std::move (scene.topology));
+        jassert (index == (int) records.size());
+        juce::ignoreUnused (index);
+
+        SceneRecord record;
+        record.name = scene.name;
+        record.plugins = std::move (scene.plugins);
+        records.push_back (std::move (record));
+    }
+
+    const auto target = first + juce::jlimit (0, (int) scenes.size() - 1, currentScene);
+    recallScene (target);
+
+    // Matches the file it came from
+    savedScene = &signalGraph.getScene (target);
+    unsavedChanges = false;
+}
+
+// ****************************************************************************
+std::vector<SceneRecipe> SceneCache::createSnapshot (int& currentScene, bool captureAll) {
+
+    std::vector<SceneRecipe> snapshot;
+    currentScene = 0;
+
+    for (int i = 0; i < (int) records.size(); ++i) {
+        auto& record = records[(size_t) i];
+        if (record.discarded)
+            continue;
+
+        if (captureAll && record.warm && record.pendingLoads == 0)
+            captureScene (i);
+        if (i == signalGraph.getCurrentScene())
+            currentScene = (int) snapshot.size();
+
+        SceneRecipe scene;
+        scene.name = record.name;
+        scene.topology = signalGraph.getScene (i).topology;
+        scene.plugins = record.plugins;
+        snapshot.push_back (std::move (scene));
+    }
+
+    savedScene = &signalGraph.getScene (signalGraph.getCurrentScene());
+    unsavedChanges = false;
+    return snapshot;
+}
+
+// ****************************************************************************
+void SceneCache::releaseBoardFile (const juce::File& file) {
+
+    for (auto& record : records)
+        for (auto& plugin : record.plugins)
+            if (plugin.source != nullptr && plugin.source->getFile() == file)
+                plugin.loadState();
+}
+
+// ****************************************************************************
+void SceneCache::collectGarbage() {
+
+    // Scenes replaced by a board go as soon as nothing refers to them
+    for (int i = (int) records.size(); --i >= 0;) {
+        if (records[(size_t) i].discarded && signalGraph.isSceneIdle (i)) {
+            signalGraph.unloadScene (i);
+            signalGraph.removeScene (i);
+            records.erase (records.begin() + i);
+        }
+    }
+
+    int numWarm = 0;
+    for (auto& record : records)
+        if ((record.warm || record.pendingLoads > 0) && ! record.discarded)
+            ++numWarm;
+
+    while (numWarm > maxWarmScenes) {
+        int victim = -1;
+        for (size_t i = 0; i < records.size(); ++i) {
+            auto& record = records[i];
+            if (record.warm && ! record.discarded && record.pendingLoads == 0 && signalGraph.isSceneIdle ((int) i)
+                 && (victim < 0 || record.lastUsed < records[(size_t) victim].lastUsed))
+                victim = (int) i;
+        }
+
+        // Everything over budget is still in use, try again later
+        if (victim < 0)
+            return;
+
+        captureScene (victim);
+        signalGraph.unloadScene (victim);
+
+        auto& record = records[(size_t) victim];
+        record.warm = false;
+        ++record.generation;
+        --numWarm;
+    }
+}
@@ -38,7 +38,7 @@
 // ****************************************************************************
 Settings::Settings(AudioDeviceManager& devManager) {
  
-    audioSetupComp.reset (new AudioDeviceSelectorComponent (devManager, 0, 16, 0, 16, false, false, true, true));
+    audioSetupComp.reset (new AudioDeviceSelectorComponent (devManager, 0, 16, 0, 16, true, false, true, true));
     addAndMakeVisible (audioSetupComp.get());
 }
 
@@ -0,0 +1,264 @@
+// ****************************************************************************
+//     Filename: SharedAudioRing.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Shared-memory audio transport module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "SharedAudioRing.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#endif
+
+#if JUCE_LINUX
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #include <ctime>
+#endif
+
+static_assert (std::atomic<uint32_t>::is_always_lock_free, "Ring sequence numbers must be address-free");
+
+// ****************************************************************************
+SharedAudioRing::SharedAudioRing (const juce::File& file, std::unique_ptr<juce::MemoryMappedFile> mappedFile)
+    : mapping (std::move (mappedFile)) {
+
+    auto* base = static_cast<char*> (mapping->getData());
+    header = reinterpret_cast<Header*> (base);
+    audio = reinterpret_cast<float*> (base + headerSize);
+
+   #if JUCE_WINDOWS
+    // Auto-reset, so a wake nobody was waiting for costs one extra check
+    const auto name = "Local\\" + file.getFileNameWithoutExtension();
+    requestEvent = CreateEventW (nullptr, FALSE, FALSE, (name + "-request").toWideCharPointer());
+    responseEvent = CreateEventW (nullptr, FALSE, FALSE, (name + "-response").toWideCharPointer());
+   #else
+    juce::ignoreUnused (file);
+   #endif
+}
+
+// ****************************************************************************
+SharedAudioRing::~SharedAudioRing() {
+
+   #if JUCE_WINDOWS
+    for (auto* event : { requestEvent, responseEvent })
+        if (event != nullptr)
+            CloseHandle (event);
+   #endif
+}
+
+// ****************************************************************************
+size_t SharedAudioRing::getMappingSize (int maxBlockSize, int numChannels) {
+
+    return headerSize + sizeof (float) * (size_t) numSlots * (size_t) numChannels * (size_t) maxBlockSize;
+}
+
+// ****************************************************************************
+juce::File SharedAudioRing::createBackingFile() {
+
+   #if JUCE_LINUX
+    const auto name = "MoodBoard-" + juce::String ((int) getpid()) + "-" + juce::Uuid().toString() + ".ring";
+
+    juce::File shm ("/dev/shm");
+    if (shm.isDirectory())
+        return shm.getChildFile (name);
+   #else
+    const auto name = "MoodBoard-" + juce::Uuid().toString() + ".ring";
+   #endif
+
+    return juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile (name);
+}
+
+// ****************************************************************************
+void SharedAudioRing::removeStaleFiles() {
+
+   #if JUCE_LINUX
+    // A ring whose host is no longer running belongs to nobody. Files from
+    //  before the process id was part of the name don't parse and go too.
+    for (const auto& folder : { juce::File ("/dev/shm"), juce::File::getSpecialLocation (juce::File::tempDirectory) }) {
+        for (const auto& file : folder.findChildFiles (juce::File::findFiles, false, "MoodBoard-*.ring")) {
+            const auto pid = file.getFileNameWithoutExtension().fromFirstOccurrenceOf ("-", false, false)
+                                                                .upToFirstOccurrenceOf ("-", false, false);
+            if (pid.isEmpty() || ! pid.containsOnly ("0123456789") || ! juce::File ("/proc/" + pid).isDirectory())
+                file.deleteFile();
+        }
+    }
+   #endif
+}
+
+// ****************************************************************************
+std::unique_ptr<SharedAudioRing> SharedAudioRing::create (const juce::File& file, int maxBlockSize, int numChannels) {
+
+    numChannels = juce::jlimit (1, maxChannels, numChannels);
+
+    juce::MemoryBlock zeros (getMappingSize (maxBlockSize, numChannels), true);
+    if (! file.replaceWithData (zeros.getData(), zeros.getSize()))
+        return nullptr;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readWrite);
+    if (mapped->getData() == nullptr)
+        return nullptr;
+
+    std::unique_ptr<SharedAudioRing> ring (new SharedAudioRing (file, std::move (mapped)));
+
+    auto* h = new (ring->header) Header();
+    h->maxBlockSize = maxBlockSize;
+    h->numChannels = numChannels;
+    h->request.store (0);
+    h->response.store (0);
+    h->shutdown.store (0);
+    std::atomic_thread_fence (std::memory_order_release);
+    h->magic = ringMagic;
+
+    return ring;
+}
+
+// ****************************************************************************
+std::unique_ptr<SharedAudioRing> SharedAudioRing::open (const juce::File& file) {
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readWrite);
+    if (mapped->getData() == nullptr || mapped->getSize() < headerSize)
+        return nullptr;
+
+    std::unique_ptr<SharedAudioRing> ring (new SharedAudioRing (file, std::move (mapped)));
+    if (ring->header->magic != ringMagic
+         || ring->mapping->getSize() < getMappingSize (ring->header->maxBlockSize, ring->header->numChannels))
+        return nullptr;
+
+    return ring;
+}
+
+// ****************************************************************************
+float* SharedAudioRing::getChannel (uint32_t sequence, int channel) const {
+
+    const auto slot = (size_t) (sequence % numSlots);
+    const auto blockFloats = (size_t) header->maxBlockSize;
+    return audio + (slot * (size_t) header->numChannels + (size_t) channel) * blockFloats;
+}
+
+// ****************************************************************************
+void SharedAudioRing::submitRequest (uint32_t sequence, int numSamples) {
+
+    header->slotSamples[sequence % numSlots] = numSamples;
+    header->request.store (sequence, std::memory_order_release);
+    futexWake (header->request);
+}
+
+// ****************************************************************************
+bool SharedAudioRing::waitForResponse (uint32_t sequence, int timeoutMicroseconds) {
+
+    return waitUntil (header->response, sequence, timeoutMicroseconds);
+}
+
+// ****************************************************************************
+bool SharedAudioRing::waitForRequest (uint32_t lastHandled, int timeoutMicroseconds) {
+
+    return waitUntil (header->request, lastHandled + 1, timeoutMicroseconds);
+}
+
+// ****************************************************************************
+void SharedAudioRing::submitResponse (uint32_t sequence) {
+
+    header->response.store (sequence, std::memory_order_release);
+    futexWake (header->response);
+}
+
+// ****************************************************************************
+void SharedAudioRing::requestShutdown() {
+
+    header->shutdown.store (1, std::memory_order_release);
+    futexWake (header->request);
+}
+
+// ****************************************************************************
+bool SharedAudioRing::waitUntil (std::atomic<uint32_t>& word, uint32_t target, int timeoutMicroseconds) const {
+
+    // Sequence numbers wrap, so compare their distance rather than their value
+    auto reached = [&] (uint32_t value) { return (int32_t) (value - target) >= 0; };
+
+    for (int i = 0; i < spinIterations; ++i)
+        if (reached (word.load (std::memory_order_acquire)))
+            return true;
+
+    const auto ticksPerMicrosecond = (double) juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+    const auto deadline = juce::Time::getHighResolutionTicks() + (juce::int64) (timeoutMicroseconds * ticksPerMicrosecond);
+
+    for (;;) {
+        const auto value = word.load (std::memory_order_acquire);
+        if (reached (value))
+            return true;
+        if (isShutdown())
+            return false;
+
+        const auto remaining = (int) ((double) (deadline - juce::Time::getHighResolutionTicks()) / ticksPerMicrosecond);
+        if (remaining <= 0)
+            return false;
+
+        futexWait (word, value, remaining);
+    }
+}
+
+// ****************************************************************************
+void SharedAudioRing::futexWait (std::atomic<uint32_t>& word, uint32_t expected, int timeoutMicroseconds) const {
+
+   #if JUCE_LINUX
+    // Not FUTEX_PRIVATE: the word lives in memory shared with another process
+    timespec timeout { timeoutMicroseconds / 1000000, (long) (timeoutMicroseconds % 1000000) * 1000 };
+    syscall (SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+   #elif JUCE_WINDOWS
+    // WaitOnAddress only works within a process, hence the events. Waits
+    //  are in whole milliseconds, so anything shorter just yields.
+    auto* event = &word == &header->request ? requestEvent : responseEvent;
+    if (event == nullptr || timeoutMicroseconds < 1000) {
+        std::this_thread::yield();
+        return;
+    }
+    if (word.load (std::memory_order_acquire) == expected)
+        WaitForSingleObject (event, (DWORD) (timeoutMicroseconds / 1000));
+   #else
+    // No shared-memory wait to be had, so nap in short steps instead of
+    //  spinning; an idle child wakes a couple of thousand times a second
+    juce::ignoreUnused (word, expected);
+    std::this_thread::sleep_for (std::chrono::microseconds (juce::jmin (timeoutMicroseconds, 500)));
+   #endif
+}
+
+// ****************************************************************************
+void SharedAudioRing::futexWake (std::atomic<uint32_t>& word) const {
+
+   #if JUCE_LINUX
+    syscall (SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+   #elif JUCE_WINDOWS
+    if (auto* event = &word == &header->request ? requestEvent : responseEvent)
+        SetEvent (event);
+   #else
+    juce::ignoreUnused (word);
+   #endif
+}
@@ -0,0 +1,1585 @@
+// ****************************************************************************
+//     Filename: SignalGraph.cpp
+// Date Created: 10/17/2026
+//
+//     Comments: Board signal graph and compiled schedule module
+//               Build Environment: VSC, CMake, Juce
+//
+// This file is part of the MoodBoard Project.
+//
+// MIT License
+//
+// Copyright (c) 2025 Jamie Robertson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// ****************************************************************************
+
+#include "SignalGraph.h"
+#include "AudioProfiler.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && JUCE_64BIT
+ #include <arm_neon.h>
+#endif
+
+// ****************************************************************************
+int BoardTopology::addNode (NodeKind kind, const juce::String& name, int slot) {
+
+    nodes.push_back ({ kind, name, slot });
+    return (int) nodes.size() - 1;
+}
+
+// ****************************************************************************
+void BoardTopology::connect (int source, int dest, int sourcePort) {
+
+    edges.push_back ({ source, sourcePort, dest });
+}
+
+// ****************************************************************************
+BoardTopology BoardTopology::createDefaultBoard() {
+
+    BoardTopology board;
+
+    auto input    = board.addNode (NodeKind::input,    "Input");
+    auto abSwitch = board.addNode (NodeKind::abSwitch, "A/B Switch");
+    auto looper   = board.addNode (NodeKind::slot,     "Looper",   0);
+    auto granular = board.addNode (NodeKind::slot,     "Granular", 1);
+    auto delay    = board.addNode (NodeKind::slot,     "Delay",    2);
+    auto reverb   = board.addNode (NodeKind::slot,     "Reverb",   3);
+    auto multiFx  = board.addNode (NodeKind::slot,     "Multi-FX", 4);
+    auto mixer    = board.addNode (NodeKind::mixer,    "Mixer");
+    auto output   = board.addNode (NodeKind::output,   "Output");
+
+    board.connect (input, abSwitch);
+
+    // Path A
+    board.connect (abSwitch, looper, 0);
+    board.connect (looper, granular);
+    board.connect (granular, delay);
+    board.connect (delay, reverb);
+    board.connect (reverb, mixer);
+
+    // Path B
+    board.connect (abSwitch, multiFx, 1);
+    board.connect (multiFx, mixer);
+
+    board.connect (mixer, output);
+    return board;
+}
+
+// ****************************************************************************
+CompiledGraph::CompiledGraph (int numBuffers, int numChannels, int blockSize)
+    : channelsPerBuffer (numChannels),
+      maxBlockSize (blockSize),
+      pool (juce::jmax (1, numBuffers * numChannels), blockSize),
+      views ((size_t) numBuffers) {
+
+    pool.clear();
+
+    for (int ch = 0; ch < pool.getNumChannels(); ++ch)
+        channelPointers.push_back (pool.getWritePointer (ch));
+
+    for (int b = 0; b < numBuffers; ++b)
+        views[(size_t) b].setDataToReferTo (&channelPointers[(size_t) (b * channelsPerBuffer)],
+                                            channelsPerBuffer, maxBlockSize);
+}
+
+// ****************************************************************************
+void CompiledGraph::attachDeviceOutputs (float* const* outputChannelData, int numOutputChannels, int offset) {
+
+    if (deviceBuffer < 0)
+        return;
+
+    // Anything short of two distinct channels falls back to the pool and a copy
+    const bool useDevice = numOutputChannels >= 2 && outputChannelData[0] != nullptr
+                        && outputChannelData[1] != nullptr && outputChannelData[0] != outputChannelData[1];
+
+    for (int ch = 0; ch < 2; ++ch) {
+        const auto index = deviceBuffer * channelsPerBuffer + ch;
+        channelPointers[(size_t) index] = useDevice ? outputChannelData[ch] + offset : pool.getWritePointer (index);
+    }
+}
+
+// ****************************************************************************
+void CompiledGraph::takeReblockState (const CompiledGraph& previous) {
+
+    // Carry the part-filled block over, so a rebuild doesn't drop or repeat audio
+    if (reblockSize == 0 || previous.reblockSize != reblockSize)
+        return;
+
+    reblockPosition = previous.reblockPosition;
+    for (int ch = 0; ch < 2; ++ch) {
+        reblockInput.copyFrom (ch, 0, previous.reblockInput, ch, 0, reblockSize);
+        reblockOutput.copyFrom (ch, 0, previous.reblockOutput, ch, 0, reblockSize);
+    }
+}
+
+// ****************************************************************************
+void CompiledGraph::delayBuffer (int line, int source, int dest, bool add, int numSamples) {
+
+    auto& delay = delayLines[(size_t) line];
+
+    for (int ch = 0; ch < channelsPerBuffer; ++ch) {
+        auto* stored = delay.blocks.getWritePointer (delay.position * channelsPerBuffer + ch);
+        auto* in = getChannel (source, ch);
+        auto* out = getChannel (dest, ch);
+
+        if (add) {
+            juce::FloatVectorOperations::add (out, stored, numSamples);
+            juce::FloatVectorOperations::copy (stored, in, numSamples);
+        }
+        else if (in == out) {
+            for (int i = 0; i < numSamples; ++i)
+                std::swap (stored[i], out[i]);
+        }
+        else {
+            juce::FloatVectorOperations::copy (out, stored, numSamples);
+            juce::FloatVectorOperations::copy (stored, in, numSamples);
+        }
+    }
+
+    delay.position = (delay.position + 1) % delay.numBlocks;
+}
+
+// ****************************************************************************
+juce::AudioBuffer<float>& CompiledGraph::getView (int buffer, int numSamples) {
+
+    // Re-pointing a buffer at existing channels never allocates
+    auto& view = views[(size_t) buffer];
+    view.setDataToReferTo (&channelPointers[(size_t) (buffer * channelsPerBuffer)],
+                           channelsPerBuffer, numSamples);
+    return view;
+}
+
+// ****************************************************************************
+void CompiledGraph::copyBuffer (int source, int dest, int numSamples) const {
+
+    for (int ch = 0; ch < channelsPerBuffer; ++ch)
+        juce::FloatVectorOperations::copy (getChannel (dest, ch), getChannel (source, ch), numSamples);
+}
+
+// ****************************************************************************
+void CompiledGraph::clearBuffer (int dest, int numSamples) const {
+
+    for (int ch = 0; ch < channelsPerBuffer; ++ch)
+        juce::FloatVectorOperations::clear (getChannel (dest, ch), numSamples);
+}
+
+// ****************************************************************************
+static bool isBelow (const float* samples, int numSamples, float threshold) {
+
+    // Compares four samples at a time and bails out at the first group with
+    //  anything above the threshold, which is usually the first one
+    int i = 0;
+
+   #if JUCE_INTEL
+    const auto absMask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+    const auto limit = _mm_set1_ps (threshold);
+
+    for (; i + 4 <= numSamples; i += 4)
+        if (_mm_movemask_ps (_mm_cmpge_ps (_mm_and_ps (_mm_loadu_ps (samples + i), absMask), limit)) != 0)
+            return false;
+   #elif JUCE_ARM && JUCE_64BIT
+    const auto limit = vdupq_n_f32 (threshold);
+
+    for (; i + 4 <= numSamples; i += 4)
+        if (vmaxvq_u32 (vcageq_f32 (vld1q_f32 (samples + i), limit)) != 0)
+            return false;
+   #endif
+
+    for (; i < numSamples; ++i)
+        if (std::abs (samples[i]) >= threshold)
+            return false;
+
+    return true;
+}
+
+// ****************************************************************************
+bool CompiledGraph::isSilent (int buffer, int numSamples, float threshold) const {
+
+    for (int ch = 0; ch < channelsPerBuffer; ++ch)
+        if (! isBelow (getChannel (buffer, ch), numSamples, threshold))
+            return false;
+    return true;
+}
+
+// ****************************************************************************
+SignalGraph::SignalGraph() {
+
+    addScene ("Default", {});
+}
+
+// ****************************************************************************
+SignalGraph::~SignalGraph() {
+
+    // The audio callback must have been removed before we get here
+    delete pendingGraph.exchange (nullptr);
+    delete activeGraph;
+    activeGraph = nullptr;
+
+    workerPool.reset();
+}
+
+// ****************************************************************************
+void SignalGraph::setTopology (BoardTopology newTopology) {
+
+    auto& scene = *scenes[(size_t) currentScene];
+    scene.topology = std::move (newTopology);
+
+    int numSlots = 0;
+    for (auto& node : scene.topology.getNodes())
+        if (node.kind == NodeKind::slot)
+            numSlots = juce::jmax (numSlots, node.slot + 1);
+
+    scene.slots.resize ((size_t) numSlots);
+    for (auto& slot : scene.slots)
+        if (slot.processor == nullptr)
+            slot.processor = std::make_unique<SlotProcessor>();
+
+    for (auto& node : scene.topology.getNodes())
+        if (node.kind == NodeKind::slot && scene.slots[(size_t) node.slot].name.isEmpty())
+            scene.slots[(size_t) node.slot].name = node.name;
+}
+
+// ****************************************************************************
+int SignalGraph::findSlot (const juce::String& name) const {
+
+    auto& slots = scenes[(size_t) currentScene]->slots;
+    for (size_t i = 0; i < slots.size(); ++i)
+        if (slots[i].name == name)
+            return (int) i;
+    return -1;
+}
+
+// ****************************************************************************
+void SignalGraph::swapSlotPlugin (int index, std::unique_ptr<juce::AudioPluginInstance> instance) {
+
+    requestSwap (*scenes[(size_t) currentScene], index, std::move (instance));
+}
+
+// ****************************************************************************
+void SignalGraph::requestSwap (BoardScene& scene, int index, std::unique_ptr<juce::AudioPluginInstance> instance) {
+
+    auto& slot = scene.slots[(size_t) index];
+    if (instance != nullptr)
+        prepareIfStale (*instance);
+
+    // One swap at a time per slot, the newest request wins. A full command
+    //  queue holds it back the same way until collectGarbage() comes round.
+    if (slot.processor->swapState.load (std::memory_order_acquire) != SlotProcessor::idle || ! canPost()) {
+        slot.queued = std::move (instance);
+        slot.hasQueued = true;
+        return;
+    }
+
+    slot.outgoing = std::move (slot.plugin);
+    slot.plugin = std::move (instance);
+    slot.processor->swapState.store (SlotProcessor::requested, std::memory_order_release);
+    post ({ GraphCommand::Kind::swapPlugin, slot.processor.get(), slot.plugin.get(), 0 });
+
+    // The new plugin may want a different channel count
+    if (&scene == scenes[(size_t) currentScene].get())
+        rebuild();
+}
+
+// ****************************************************************************
+bool SignalGraph::isSwapInProgress (int index) const {
+
+    auto& slot = scenes[(size_t) currentScene]->slots[(size_t) index];
+    return slot.hasQueued || slot.processor->swapState.load() != SlotProcessor::idle;
+}
+
+// ****************************************************************************
+int SignalGraph::addScene (const juce::String& name, BoardTopology sceneTopology) {
+
+    scenes.push_back (std::make_unique<BoardScene>());
+    scenes.back()->name = name;
+
+    // setTopology() sizes the slot table of the current scene
+    const auto previous = currentScene;
+    currentScene = (int) scenes.size() - 1;
+    setTopology (std::move (sceneTopology));
+    currentScene = previous;
+
+    return (int) scenes.size() - 1;
+}
+
+// ****************************************************************************
+bool SignalGraph::selectScene (int index) {
+
+    if (! juce::isPositiveAndBelow (index, (int) scenes.size()))
+        return false;
+
+    const auto previous = currentScene;
+    currentScene = index;
+    if (! rebuild()) {
+        currentScene = previous;
+        return false;
+    }
+    return true;
+}
+
+// ****************************************************************************
+bool SignalGraph::isSceneIdle (int index) const {
+
+    // Once the audio thread has published a different scene it never goes
+    //  back to an old schedule, and only the message thread selects scenes.
+    //  Commands still in the queue may point into any scene.
+    return index != currentScene && runningScene.load (std::memory_order_acquire) != scenes[(size_t) index].get()
+           && commandFifo.getNumReady() == 0;
+}
+
+// ****************************************************************************
+bool SignalGraph::setScenePlugin (int sceneIndex, int slotIndex, std::unique_ptr<juce::AudioPluginInstance> instance) {
+
+    if (! isSceneIdle (sceneIndex))
+        return false;
+
+    auto& slot = scenes[(size_t) sceneIndex]->slots[(size_t) slotIndex];
+    if (instance != nullptr)
+        prepareIfStale (*instance);
+
+    slot.plugin = std::move (instance);
+    slot.processor->current = slot.plugin.get();
+    return true;
+}
+
+// ****************************************************************************
+bool SignalGraph::unloadScene (int index) {
+
+    if (! isSceneIdle (index))
+        return false;
+
+    for (auto& slot : scenes[(size_t) index]->slots) {
+        auto& processor = *slot.processor;
+        processor.current = nullptr;
+        processor.fadingOut = nullptr;
+        processor.incoming = nullptr;
+        processor.swapPending = false;
+        processor.swapState.store (SlotProcessor::idle);
+
+        slot.plugin = nullptr;
+        slot.outgoing = nullptr;
+        slot.queued = nullptr;
+        slot.hasQueued = false;
+    }
+    return true;
+}
+
+// ****************************************************************************
+bool SignalGraph::removeScene (int index) {
+
+    if (! isSceneIdle (index))
+        return false;
+
+    // A retired schedule may still point into the scene, but it is never run again
+    scenes.erase (scenes.begin() + index);
+    if (currentScene > index)
+        --currentScene;
+    return true;
+}
+
+// ****************************************************************************
+void SignalGraph::setCrossfadeMs (double milliseconds) {
+
+    crossfadeMs = milliseconds;
+    crossfadeSamples.store (juce::jmax (1, juce::roundToInt (crossfadeMs * 0.001 * currentSampleRate)));
+}
+
+// ****************************************************************************
+void SignalGraph::prepare (double sampleRate, int maxBlockSize) {
+
+    // In fixed block mode the plugins only ever see that size, whatever the device does
+    const int blockSize = fixedBlockSize > 0 ? fixedBlockSize : maxBlockSize;
+    const bool configChanged = sampleRate != currentSampleRate || blockSize != currentBlockSize;
+    currentSampleRate = sampleRate;
+    currentBlockSize = blockSize;
+    reblockSize = fixedBlockSize;
+    tailHoldSamples = juce::roundToInt (sampleRate * tailHoldSeconds);
+    ticksPerSample = (double) juce::Time::getHighResolutionTicksPerSecond() / sampleRate;
+    watchdogForgiveSamples = juce::roundToInt (sampleRate * watchdogForgiveSeconds);
+    setCrossfadeMs (crossfadeMs);
+
+    // The workers' real-time budget is worked out from the block length
+    if (workerPool == nullptr || configChanged || workerConfigChanged) {
+        const auto numWorkers = workerCores.isEmpty() ? RealtimeThreadPool::getDefaultNumWorkers() : workerCores.size();
+        workerPool = std::make_unique<RealtimeThreadPool> (numWorkers, currentSampleRate, currentBlockSize,
+                                                           workerCores, workerPriority);
+        workerConfigChanged = false;
+    }
+
+    // Every loaded scene stays prepared so it can be switched to instantly,
+    //  along with anything still fading out or waiting to be swapped in. Plugin
+    //  formats expect this on the message thread, and some take its lock, so
+    //  it's done here one plugin at a time and never on the real-time workers.
+    for (auto& scene : scenes)
+        for (auto& slot : scene->slots)
+            for (auto* plugin : { slot.plugin.get(), slot.outgoing.get(), slot.queued.get() })
+                if (plugin != nullptr)
+                    preparePlugin (*plugin, currentSampleRate, currentBlockSize);
+
+    rebuild();
+}
+
+// ****************************************************************************
+void SignalGraph::preparePlugin (juce::AudioPluginInstance& plugin, double sampleRate, int blockSize) {
+
+    // Recorded on the instance so a late arrival can be checked against the device
+    plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    plugin.prepareToPlay (sampleRate, blockSize);
+}
+
+// ****************************************************************************
+void SignalGraph::prepareIfStale (juce::AudioPluginInstance& plugin) const {
+
+    // Loads run in the background, so the device may have changed since this
+    //  instance was prepared
+    if (plugin.getSampleRate() != currentSampleRate || plugin.getBlockSize() != currentBlockSize)
+        preparePlugin (plugin, currentSampleRate, currentBlockSize);
+}
+
+// ****************************************************************************
+void SignalGraph::setWorkerCores (const juce::Array<int>& cores, int fifoPriority) {
+
+    workerCores = cores;
+    workerPriority = fifoPriority;
+    workerConfigChanged = true;
+}
+
+// ****************************************************************************
+void SignalGraph::releaseResources() {
+
+    for (auto& scene : scenes)
+        for (auto& slot : scene->slots)
+            for (auto* plugin : { slot.plugin.get(), slot.outgoing.get(), slot.queued.get() })
+                if (plugin != nullptr)
+                    plugin->releaseResources();
+}
+
+// ****************************************************************************
+bool SignalGraph::rebuild() {
+
+    juce::String error;
+    auto compiled = compile (error);
+    if (compiled == nullptr) {
+        DBG ("Graph compile failed: " << error);
+        return false;
+    }
+
+    latencySamples.store (compiled->latencySamples);
+
+    // Only the ends of the board pay for inter-sample peaks
+    auto& nodes = getTopology().getNodes();
+    for (size_t n = 0; n < nodes.size(); ++n)
+        if (auto* tap = meters.getTapForNode ((int) n))
+            tap->setTruePeakEnabled (nodes[n].kind == NodeKind::input || nodes[n].kind == NodeKind::output);
+
+    // If the audio thread never picked up the previous schedule we own it again
+    delete pendingGraph.exchange (compiled.release(), std::memory_order_acq_rel);
+    return true;
+}
+
+// ****************************************************************************
+void SignalGraph::collectGarbage() {
+
+    // Retired schedules go to the garbage collector thread, but plugins have
+    //  to be deleted on the message thread, so outgoing ones come back here
+    for (auto& scene : scenes) {
+        for (size_t i = 0; i < scene->slots.size(); ++i) {
+            auto& slot = scene->slots[i];
+            if (slot.processor->swapState.load (std::memory_order_acquire) == SlotProcessor::finished) {
+                // The audio thread has let go of the old plugin
+                slot.outgoing = nullptr;
+                slot.processor->swapState.store (SlotProcessor::idle, std::memory_order_release);
+            }
+
+            if (slot.hasQueued && slot.processor->swapState.load (std::memory_order_acquire) == SlotProcessor::idle) {
+                slot.hasQueued = false;
+                requestSwap (*scene, (int) i, std::move (slot.queued));
+            }
+        }
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::setActivePath (int path) {
+
+    if (! post ({ GraphCommand::Kind::selectPath, nullptr, nullptr, path == 0 ? 0 : 1 }))
+        DBG ("Command queue full, path change dropped");
+}
+
+// ****************************************************************************
+void SignalGraph::setSlotBypassed (int index, bool shouldBypass) {
+
+    auto* processor = scenes[(size_t) currentScene]->slots[(size_t) index].processor.get();
+    if (! post ({ GraphCommand::Kind::setBypass, processor, nullptr, shouldBypass ? 1 : 0 }))
+        DBG ("Command queue full, bypass change dropped");
+}
+
+// ****************************************************************************
+bool SignalGraph::isSlotBypassed (int index) const {
+
+    return scenes[(size_t) currentScene]->slots[(size_t) index].processor->bypassed.load();
+}
+
+// ****************************************************************************
+juce::StringArray SignalGraph::takeWatchdogTrips() {
+
+    juce::StringArray names;
+    for (auto& scene : scenes) {
+        for (auto& slot : scene->slots) {
+            auto expected = (int) SlotProcessor::tripped;
+            if (slot.processor->watchdogState.compare_exchange_strong (expected, SlotProcessor::reported))
+                names.add (slot.name);
+        }
+    }
+    return names;
+}
+
+// ****************************************************************************
+void SignalGraph::restoreWatchdogBypasses() {
+
+    for (int i = 0; i < getNumSlots(); ++i) {
+        if (getSlot (i).processor->watchdogState.exchange (SlotProcessor::clear) != SlotProcessor::clear)
+            setSlotBypassed (i, false);
+    }
+}
+
+// ****************************************************************************
+bool SignalGraph::post (const GraphCommand& command) {
+
+    const auto scope = commandFifo.write (1);
+    if (scope.blockSize1 > 0)
+        commands[(size_t) scope.startIndex1] = command;
+    else if (scope.blockSize2 > 0)
+        commands[(size_t) scope.startIndex2] = command;
+    else
+        return false;
+    return true;
+}
+
+// ****************************************************************************
+void SignalGraph::applyCommands() {
+
+    // Everything the message thread asked for since the last block lands
+    //  together, in the order it was asked for
+    const auto scope = commandFifo.read (commandFifo.getNumReady());
+
+    auto apply = [this] (int start, int count) {
+        for (int i = start; i < start + count; ++i) {
+            auto& command = commands[(size_t) i];
+            switch (command.kind) {
+                case GraphCommand::Kind::selectPath:
+                    activePath.store (command.value, std::memory_order_relaxed);
+                break;
+                case GraphCommand::Kind::setBypass:
+                    command.slot->bypassed.store (command.value != 0, std::memory_order_relaxed);
+                break;
+                case GraphCommand::Kind::swapPlugin:
+                    command.slot->incoming = command.plugin;
+                    command.slot->swapPending = true;
+                break;
+            }
+        }
+    };
+
+    apply (scope.startIndex1, scope.blockSize1);
+    apply (scope.startIndex2, scope.blockSize2);
+}
+
+// ****************************************************************************
+int SignalGraph::getSleepAfterSamples (const juce::AudioPluginInstance* plugin) const {
+
+    // An empty slot costs nothing, and a plugin with an endless tail (the
+    //  looper, a freeze) can make sound from silence, so neither sleeps
+    if (plugin == nullptr)
+        return -1;
+
+    const auto tail = plugin->getTailLengthSeconds();
+    if (! std::isfinite (tail) || tail > maxSleepTailSeconds)
+        return -1;
+
+    // Some plugins report no tail and ring anyway, so give them a moment
+    return juce::roundToInt (currentSampleRate * juce::jmax (tail, minSleepHoldSeconds));
+}
+
+// ****************************************************************************
+std::unique_ptr<CompiledGraph> SignalGraph::compile (juce::String& error) const {
+
+    auto& topology = scenes[(size_t) currentScene]->topology;
+    auto& slots = scenes[(size_t) currentScene]->slots;
+    auto& nodes = topology.getNodes();
+    auto& edges = topology.getEdges();
+    const auto numNodes = nodes.size();
+
+    // Topological sort (Kahn)
+    std::vector<int> inDegree (numNodes, 0);
+    for (auto& e : edges) {
+        if (! juce::isPositiveAndBelow (e.source, (int) numNodes) || ! juce::isPositiveAndBelow (e.dest, (int) numNodes)) {
+            error = "Edge refers to a missing node";
+            return nullptr;
+        }
+        ++inDegree[(size_t) e.dest];
+    }
+
+    std::vector<int> order;
+    order.reserve (numNodes);
+    for (size_t n = 0; n < numNodes; ++n)
+        if (inDegree[n] == 0)
+            order.push_back ((int) n);
+
+    for (size_t i = 0; i < order.size(); ++i)
+        for (auto& e : edges)
+            if (e.source == order[i] && --inDegree[(size_t) e.dest] == 0)
+                order.push_back (e.dest);
+
+    if (order.size() != numNodes) {
+        error = "Board contains a feedback loop";
+        return nullptr;
+    }
+
+    // Steps are emitted with value ids in place of buffers: one value per node
+    //  output port, plus the hand-over values of pipelined chains. Buffers are
+    //  assigned to values once the schedule is known.
+    std::vector<std::array<int, 2>> outputValue (numNodes, std::array<int, 2> { -1, -1 });
+    int numValues = 0;
+    for (size_t n = 0; n < numNodes; ++n) {
+        switch (nodes[n].kind) {
+            case NodeKind::abSwitch:
+                outputValue[n][0] = numValues++;
+                outputValue[n][1] = numValues++;
+            break;
+            case NodeKind::output:
+            break;
+            default:
+                outputValue[n][0] = numValues++;
+            break;
+        }
+    }
+
+    // Size every buffer for the widest plugin on the board
+    int numChannels = 2;
+    for (auto& slot : slots)
+        if (slot.plugin != nullptr)
+            numChannels = juce::jmax (numChannels, slot.plugin->getTotalNumInputChannels(),
+                                      slot.plugin->getTotalNumOutputChannels());
+
+    std::vector<GraphStep> steps;
+    std::vector<GraphTask> tasks;
+    std::vector<GraphPhase> phases;
+    steps.reserve (numNodes);
+    int latencySamples = 0;
+
+    std::vector<std::vector<int>> successors (numNodes);
+    std::vector<int> numPredecessors (numNodes, 0);
+    for (auto& e : edges) {
+        successors[(size_t) e.source].push_back (e.dest);
+        ++numPredecessors[(size_t) e.dest];
+    }
+
+    std::vector<bool> emitted (numNodes, false);
+
+    // Which side of an A/B switch each node is on, -1 for neither or both
+    std::vector<int> nodePath (numNodes, -1);
+    for (auto n : order) {
+        int path = -2;
+        for (auto& e : edges) {
+            if (e.dest != n)
+                continue;
+            const auto sourcePath = nodes[(size_t) e.source].kind == NodeKind::abSwitch ? e.sourcePort : nodePath[(size_t) e.source];
+            path = (path == -2 || path == sourcePath) ? sourcePath : -1;
+        }
+        // The output writes to the device, so whatever feeds it is the exit
+        if (nodes[(size_t) n].kind != NodeKind::output)
+            nodePath[(size_t) n] = juce::jmax (-1, path);
+    }
+
+    auto emitStep = [&] (int n) -> bool {
+        auto& node = nodes[(size_t) n];
+
+        GraphStep step;
+        step.node = n;
+        step.outputs = outputValue[(size_t) n];
+
+        // A path's exits are where its audio leaves it
+        step.path = nodePath[(size_t) n];
+        if (step.path >= 0) {
+            step.pathExit = successors[(size_t) n].empty();
+            for (auto next : successors[(size_t) n])
+                if (nodePath[(size_t) next] != step.path)
+                    step.pathExit = true;
+        }
+
+        for (auto& e : edges) {
+            if (e.dest != n)
+                continue;
+            if (step.numInputs == GraphStep::maxInputs) {
+                error = "Too many inputs on " + node.name;
+                return false;
+            }
+            step.inputs[(size_t) step.numInputs++] = outputValue[(size_t) e.source][(size_t) e.sourcePort];
+        }
+
+        const bool needsOneInput = node.kind != NodeKind::input && node.kind != NodeKind::mixer;
+        if ((needsOneInput && step.numInputs != 1) || (node.kind == NodeKind::mixer && step.numInputs == 0)) {
+            error = "Bad connections on " + node.name;
+            return false;
+        }
+
+        switch (node.kind) {
+            case NodeKind::input:       step.op = StepOp::readInput;    break;
+            case NodeKind::abSwitch:    step.op = StepOp::abSwitch;     break;
+            case NodeKind::mixer:       step.op = StepOp::mix;          break;
+            case NodeKind::output:      step.op = StepOp::writeOutput;  break;
+            case NodeKind::slot:
+                step.op = StepOp::process;
+                step.slot = slots[(size_t) node.slot].processor.get();
+                step.slotIndex = node.slot;
+                step.sleepAfterSamples = getSleepAfterSamples (slots[(size_t) node.slot].plugin.get());
+            break;
+        }
+
+        steps.push_back (step);
+        emitted[(size_t) n] = true;
+        return true;
+    };
+
+    auto addTask = [&] (int firstStep) {
+        tasks.emplace_back();
+        tasks.back().firstStep = firstStep;
+        tasks.back().numSteps = (int) steps.size() - firstStep;
+    };
+
+    auto addPhase = [&] (int firstTask) {
+        phases.push_back ({ firstTask, (int) tasks.size() - firstTask });
+    };
+
+    // In pipelined mode every plugin of a serial chain becomes its own task.
+    //  Stage n works on the block stage n - 1 produced during the previous
+    //  callback, handed over through a pair of buffers that swap roles every
+    //  block, so all stages of the chain can run at once on separate cores.
+    auto isPipelinable = [&] (const std::vector<int>& chain) {
+        if (chain.size() < 2)
+            return false;
+        for (auto c : chain)
+            if (nodes[(size_t) c].kind != NodeKind::slot)
+                return false;
+        return true;
+    };
+
+    auto emitPipelinedChain = [&] (const std::vector<int>& chain) -> bool {
+        const auto numStages = chain.size();
+        std::array<int, 2> previousOutputs { -1, -1 };
+
+        for (size_t stage = 0; stage < numStages; ++stage) {
+            const int firstStep = (int) steps.size();
+            if (! emitStep (chain[stage]))
+                return false;
+
+            auto& step = steps.back();
+            step.pipelined = true;
+
+            if (stage == 0)
+                step.parityInputs = { step.inputs[0], step.inputs[0] };
+            else
+                step.parityInputs = { previousOutputs[1], previousOutputs[0] };
+
+            if (stage == numStages - 1)
+                step.parityOutputs = { step.outputs[0], step.outputs[0] };
+            else
+                step.parityOutputs = { step.outputs[0], numValues++ };
+
+            previousOutputs = step.parityOutputs;
+            addTask (firstStep);
+        }
+        return true;
+    };
+
+    // Walk the sorted nodes, collecting serial runs into single-task phases.
+    //  Whenever a node fans out, the chains hanging off it (nodes with exactly
+    //  one input, up to the join) become the tasks of one parallel phase.
+    int serialStart = 0;
+
+    auto closeSerialRun = [&] {
+        if ((int) steps.size() > serialStart) {
+            const int firstTask = (int) tasks.size();
+            addTask (serialStart);
+            addPhase (firstTask);
+        }
+    };
+
+    for (auto n : order) {
+        if (emitted[(size_t) n])
+            continue;
+        if (! emitStep (n))
+            return nullptr;
+
+        if (successors[(size_t) n].size() < 2)
+            continue;
+
+        std::vector<std::vector<int>> chains;
+        for (auto next : successors[(size_t) n]) {
+            std::vector<int> chain;
+            for (auto cur = next; ! emitted[(size_t) cur] && numPredecessors[(size_t) cur] == 1; cur = successors[(size_t) cur][0]) {
+                chain.push_back (cur);
+                if (successors[(size_t) cur].size() != 1)
+                    break;
+            }
+            if (! chain.empty())
+                chains.push_back (std::move (chain));
+        }
+
+        if (chains.size() < 2)
+            continue;
+
+        closeSerialRun();
+
+        const int firstTask = (int) tasks.size();
+        for (auto& chain : chains) {
+            if (pipelined && isPipelinable (chain)) {
+                if (! emitPipelinedChain (chain))
+                    return nullptr;
+                continue;
+            }
+
+            const int firstStep = (int) steps.size();
+            for (auto c : chain)
+                if (! emitStep (c))
+                    return nullptr;
+            addTask (firstStep);
+        }
+        addPhase (firstTask);
+
+        serialStart = (int) steps.size();
+    }
+
+    closeSerialRun();
+
+    // Every stage after the first of a pipelined chain puts its output one
+    //  block later. Follow that lag through the schedule (which is in
+    //  dependency order) and hold back whichever mixer inputs arrive early, so
+    //  chains of different lengths meet in step. The lag at the output is
+    //  what pipelining adds to the board's latency.
+    std::vector<int> lagOf ((size_t) numValues, 0);
+    int outputLag = 0;
+    for (auto& step : steps) {
+        int lag = 0;
+        for (int i = 0; i < step.numInputs; ++i)
+            lag = juce::jmax (lag, lagOf[(size_t) step.inputs[(size_t) i]]);
+
+        if (step.op == StepOp::mix)
+            for (int i = 0; i < step.numInputs; ++i)
+                step.inputDelays[(size_t) i] = lag - lagOf[(size_t) step.inputs[(size_t) i]];
+        if (step.pipelined && step.parityInputs[0] != step.parityInputs[1])
+            ++lag;
+        if (step.op == StepOp::writeOutput)
+            outputLag = juce::jmax (outputLag, lag);
+
+        for (auto value : step.outputs)
+            if (value >= 0)
+                lagOf[(size_t) value] = lag;
+    }
+    latencySamples = outputLag * currentBlockSize;
+
+    // Assign buffers by liveness, walking the schedule in order. A buffer goes
+    //  back to the pool after the last step that reads its value, and a slot or
+    //  mixer that is the last reader of an input works on that buffer in place.
+    //  Tasks of a parallel phase run at once, so whatever they free can only be
+    //  reused after the phase, and the values pipelined stages hand over from
+    //  one block to the next keep a buffer of their own.
+    std::vector<int> readers ((size_t) numValues, 0);
+    std::vector<int> bufferOf ((size_t) numValues, -1);
+    std::vector<int> lastReaderTask ((size_t) numValues, -1);
+    std::vector<bool> pinned ((size_t) numValues, false);
+
+    for (auto& step : steps) {
+        for (int i = 0; i < step.numInputs; ++i)
+            ++readers[(size_t) step.inputs[(size_t) i]];
+        if (step.pipelined && step.parityOutputs[0] != step.parityOutputs[1])
+            pinned[(size_t) step.parityOutputs[0]] = pinned[(size_t) step.parityOutputs[1]] = true;
+    }
+
+    int numBuffers = 0;
+    std::vector<int> freeBuffers;
+
+    auto acquire = [&] (int value) {
+        if (pinned[(size_t) value] || freeBuffers.empty())
+            return numBuffers++;
+        const auto buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        return buffer;
+    };
+
+    for (auto& phase : phases) {
+        const bool parallel = phase.numTasks > 1;
+        std::vector<int> freedByPhase;
+
+        auto release = [&] (int value) {
+            if (! pinned[(size_t) value])
+                (parallel ? freedByPhase : freeBuffers).push_back (bufferOf[(size_t) value]);
+        };
+
+        for (int t = phase.firstTask; t < phase.firstTask + phase.numTasks; ++t) {
+            auto& task = tasks[(size_t) t];
+
+            for (int s = task.firstStep; s < task.firstStep + task.numSteps; ++s) {
+                auto& step = steps[(size_t) s];
+                const auto inputValues = step.inputs;
+                const auto outputValues = step.outputs;
+
+                // Take over an input this step is the last to read, unless
+                //  another task of the same phase reads it as well
+                int inPlace = -1;
+                if (! step.pipelined && (step.op == StepOp::process || step.op == StepOp::mix)) {
+                    for (int i = 0; i < step.numInputs && inPlace < 0; ++i) {
+                        const auto value = (size_t) inputValues[(size_t) i];
+                        if (readers[value] == 1 && ! pinned[value]
+                            && (lastReaderTask[value] < phase.firstTask || lastReaderTask[value] == t))
+                            inPlace = i;
+                    }
+                }
+
+                for (int i = 0; i < step.numInputs; ++i)
+                    step.inputs[(size_t) i] = bufferOf[(size_t) inputValues[(size_t) i]];
+
+                // The mixer accumulates into its first input
+                if (inPlace > 0) {
+                    std::swap (step.inputs[0], step.inputs[(size_t) inPlace]);
+                    std::swap (step.inputDelays[0], step.inputDelays[(size_t) inPlace]);
+                }
+
+                for (size_t port = 0; port < 2; ++port) {
+                    const auto value = outputValues[port];
+                    if (value < 0)
+                        continue;
+                    bufferOf[(size_t) value] = (port == 0 && inPlace >= 0) ? step.inputs[0] : acquire (value);
+                    step.outputs[port] = bufferOf[(size_t) value];
+                }
+
+                if (step.pipelined) {
+                    for (auto& value : step.parityInputs)
+                        value = bufferOf[(size_t) value];
+                    for (auto& value : step.parityOutputs) {
+                        if (bufferOf[(size_t) value] < 0)
+                            bufferOf[(size_t) value] = acquire (value);
+                        value = bufferOf[(size_t) value];
+                    }
+                }
+
+                // Only free inputs once the outputs are taken, so a step never
+                //  writes over a buffer it is still reading
+                for (int i = 0; i < step.numInputs; ++i) {
+                    const auto value = inputValues[(size_t) i];
+                    lastReaderTask[(size_t) value] = t;
+                    if (--readers[(size_t) value] == 0 && i != inPlace)
+                        release (value);
+                }
+
+                // Nothing reads an unconnected port past this step
+                for (auto value : outputValues)
+                    if (value >= 0 && readers[(size_t) value] == 0)
+                        release (value);
+            }
+        }
+
+        freeBuffers.insert (freeBuffers.end(), freedByPhase.begin(), freedByPhase.end());
+    }
+
+    for (auto& task : tasks)
+        task.scratchBuffer = numBuffers++;
+
+    auto graph = std::make_unique<CompiledGraph> (numBuffers, numChannels, currentBlockSize);
+    graph->steps = std::move (steps);
+    graph->tasks = std::move (tasks);
+    graph->phases = std::move (phases);
+    graph->scene = scenes[(size_t) currentScene].get();
+    graph->latencySamples = latencySamples + reblockSize;
+
+    for (auto& step : graph->steps) {
+        if (std::none_of (step.inputDelays.begin(), step.inputDelays.end(), [] (int d) { return d > 0; }))
+            continue;
+
+        step.firstDelayLine = (int) graph->delayLines.size();
+        for (int i = 0; i < step.numInputs; ++i) {
+            auto& line = graph->delayLines.emplace_back();
+            line.numBlocks = juce::jmax (1, step.inputDelays[(size_t) i]);
+            line.blocks.setSize (numChannels * line.numBlocks, currentBlockSize);
+            line.blocks.clear();
+        }
+    }
+
+    if (reblockSize > 0) {
+        graph->reblockSize = reblockSize;
+        graph->reblockInput.setSize (2, reblockSize);
+        graph->reblockOutput.setSize (2, reblockSize);
+        graph->reblockInput.clear();
+        graph->reblockOutput.clear();
+    }
+
+    // The buffer feeding the mains can be the device's own output channels, so
+    //  the last plugins write the final mix straight into them
+    int numOutputSteps = 0;
+    for (auto& step : graph->steps) {
+        if (step.op == StepOp::writeOutput) {
+            ++numOutputSteps;
+            graph->deviceBuffer = step.inputs[0];
+        }
+    }
+    if (numOutputSteps != 1)
+        graph->deviceBuffer = -1;
+
+    return graph;
+}
+
+// ****************************************************************************
+void SignalGraph::process (const float* const* inputChannelData, int numInputChannels,
+                           float* const* outputChannelData, int numOutputChannels, int numSamples,
+                           const MidiEvent* midiEvents, int numMidiEvents) {
+
+    // Pick up a newly compiled schedule at the block boundary, as long as the
+    //  garbage collector has room for the one it replaces
+    if (garbage.canRetire()) {
+        if (auto* next = pendingGraph.exchange (nullptr, std::memory_order_acq_rel)) {
+            if (activeGraph != nullptr)
+                next->takeReblockState (*activeGraph);
+            garbage.retire (activeGraph);
+            activeGraph = next;
+            runningScene.store (activeGraph->scene, std::memory_order_release);
+        }
+    }
+
+    applyCommands();
+
+    if (activeGraph == nullptr) {
+        // Nothing compiled yet, so behave like an empty board
+        for (int ch = 0; ch < numOutputChannels; ++ch) {
+            if (auto* out = outputChannelData[ch]) {
+                if (ch < 2 && numInputChannels > 0 && inputChannelData[0] != nullptr)
+                    juce::FloatVectorOperations::copy (out, inputChannelData[0], numSamples);
+                else
+                    juce::FloatVectorOperations::clear (out, numSamples);
+            }
+        }
+        return;
+    }
+
+    auto* activeProfiler = profiler.load (std::memory_order_relaxed);
+    const auto startTicks = activeProfiler != nullptr ? AudioProfiler::now() : 0;
+
+    queueMidi (midiEvents, numMidiEvents);
+
+    const int target = activePath.load (std::memory_order_relaxed) == 0 ? 0 : 1;
+    if (target != pathSwitch.target)
+        beginPathSwitch (target, streamPosition);
+    updatePathSleep (numSamples);
+
+    BlockContext context { this, activeGraph, nullptr,
+                           inputChannelData, numInputChannels,
+                           outputChannelData, numOutputChannels, 0, 0, 0, streamPosition, activeProfiler };
+
+    if (activeGraph->reblockSize > 0)
+        runReblocked (context, numSamples);
+    else
+        runBlocks (context, numSamples);
+
+    streamPosition += numSamples;
+
+    if (activeProfiler != nullptr)
+        activeProfiler->record (AudioProfiler::blockLane, AudioProfiler::blockNode, startTicks, AudioProfiler::now(), numSamples);
+}
+
+// ****************************************************************************
+void SignalGraph::runBlocks (BlockContext& context, int numSamples) {
+
+    auto& graph = *context.graph;
+
+    // Drivers are allowed to hand us more than we prepared for
+    for (context.offset = 0; context.offset < numSamples; context.offset += context.numSamples) {
+        context.numSamples = juce::jmin (graph.maxBlockSize, numSamples - context.offset);
+        context.parity = graph.blockParity;
+        graph.attachDeviceOutputs (context.outputChannelData, context.numOutputChannels, context.offset);
+        runSchedule (context);
+        graph.blockParity ^= 1;
+        dropMidiBefore (context.streamStart + context.offset + context.numSamples);
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::queueMidi (const MidiEvent* events, int numEvents) {
+
+    for (int i = 0; i < numEvents; ++i) {
+        auto& event = events[i];
+
+        // The A/B switch starts its fade on the sample the event is at, other
+        //  actions apply from this block on. Messages are kept on the stream
+        //  timeline until the block that holds them runs.
+        switch (event.kind) {
+            case MidiEvent::Kind::toggleAB:
+            case MidiEvent::Kind::selectPath: {
+                const int path = event.kind == MidiEvent::Kind::selectPath ? (event.target == 0 ? 0 : 1)
+                                                                           : 1 - pathSwitch.target;
+                activePath.store (path, std::memory_order_relaxed);
+                beginPathSwitch (path, streamPosition + event.position);
+            }
+            break;
+
+            case MidiEvent::Kind::toggleBypass:
+                for (auto& step : activeGraph->steps)
+                    if (step.op == StepOp::process && step.slotIndex == event.target)
+                        step.slot->bypassed.store (! step.slot->bypassed.load (std::memory_order_relaxed), std::memory_order_relaxed);
+            break;
+
+            case MidiEvent::Kind::message:
+                if (numPendingMidi < maxPendingMidi)
+                    pendingMidi[(size_t) numPendingMidi++] = { streamPosition + event.position, event };
+            break;
+        }
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::dropMidiBefore (juce::int64 time) {
+
+    int kept = 0;
+    for (int i = 0; i < numPendingMidi; ++i)
+        if (pendingMidi[(size_t) i].time >= time)
+            pendingMidi[(size_t) kept++] = pendingMidi[(size_t) i];
+    numPendingMidi = kept;
+}
+
+// ****************************************************************************
+void SignalGraph::runReblocked (const BlockContext& context, int numSamples) {
+
+    // The device audio passes through one block of the graph's fixed size:
+    //  each sample goes in at the same position the sample processed a block
+    //  earlier comes out of, and whenever the block fills the schedule runs.
+    auto& graph = *context.graph;
+    const int blockSize = graph.reblockSize;
+
+    const float* blockInputs[] = { graph.reblockInput.getReadPointer (0), graph.reblockInput.getReadPointer (1) };
+    float* blockOutputs[] = { graph.reblockOutput.getWritePointer (0), graph.reblockOutput.getWritePointer (1) };
+    BlockContext block { this, &graph, nullptr, blockInputs, 2, blockOutputs, 2, 0, 0, 0, 0, context.profiler };
+
+    for (int done = 0; done < numSamples;) {
+        const int position = graph.reblockPosition;
+        const int count = juce::jmin (numSamples - done, blockSize - position);
+
+        for (int ch = 0; ch < 2; ++ch) {
+            if (ch < context.numInputChannels && context.inputChannelData[ch] != nullptr)
+                juce::FloatVectorOperations::copy (graph.reblockInput.getWritePointer (ch, position),
+                                                   context.inputChannelData[ch] + done, count);
+            else
+                juce::FloatVectorOperations::clear (graph.reblockInput.getWritePointer (ch, position), count);
+        }
+
+        for (int ch = 0; ch < context.numOutputChannels; ++ch) {
+            if (auto* out = context.outputChannelData[ch]) {
+                if (ch < 2)
+                    juce::FloatVectorOperations::copy (out + done, blockOutputs[ch] + position, count);
+                else
+                    juce::FloatVectorOperations::clear (out + done, count);
+            }
+        }
+
+        done += count;
+        graph.reblockPosition += count;
+
+        if (graph.reblockPosition == blockSize) {
+            graph.reblockPosition = 0;
+            block.streamStart = context.streamStart + done - blockSize;
+            runBlocks (block, blockSize);
+        }
+    }
+}
+
+// ****************************************************************************
+float SignalGraph::getPathGain (int path, juce::int64 time) const {
+
+    // Path B's gain ramps linearly from where it was when the switch was hit
+    const auto progress = juce::jlimit (0.0, 1.0, (double) (time - pathSwitch.startTime) / pathSwitch.fadeSamples);
+    const auto gainB = pathSwitch.fromGain + ((float) pathSwitch.target - pathSwitch.fromGain) * (float) progress;
+    return path == 1 ? gainB : 1.0f - gainB;
+}
+
+// ****************************************************************************
+void SignalGraph::beginPathSwitch (int target, juce::int64 time) {
+
+    if (target == pathSwitch.target)
+        return;
+
+    pathSwitch.fromGain = getPathGain (1, time);
+    pathSwitch.target = target;
+    pathSwitch.startTime = time;
+    pathSwitch.fadeSamples = juce::jmax (1, switchFadeSamples.load (std::memory_order_relaxed));
+}
+
+// ****************************************************************************
+void SignalGraph::updatePathSleep (int numSamples) {
+
+    // A path sleeps while the switch sends it nothing for the whole callback,
+    //  re-blocking lag included, and everything leaving it has been quiet for
+    //  long enough that no tail can still be ringing out
+    const auto from = streamPosition - activeGraph->reblockSize;
+    const auto to = streamPosition + numSamples;
+
+    for (int path = 0; path < 2; ++path) {
+        bool asleep = getPathGain (path, from) == 0.0f && getPathGain (path, to) == 0.0f;
+        for (auto& step : activeGraph->steps)
+            if (step.path == path && step.pathExit && step.quietSamples < tailHoldSamples)
+                asleep = false;
+        pathAsleep[(size_t) path] = asleep;
+    }
+}
+
+// ****************************************************************************
+static void writeScaled (float* dest, const float* source, float gain, int numSamples) {
+
+    if (gain == 0.0f)
+        juce::FloatVectorOperations::clear (dest, numSamples);
+    else if (gain == 1.0f)
+        juce::FloatVectorOperations::copy (dest, source, numSamples);
+    else
+        juce::FloatVectorOperations::multiply (dest, source, gain, numSamples);
+}
+
+// ****************************************************************************
+void SignalGraph::switchPaths (const CompiledGraph& graph, const GraphStep& step, juce::int64 blockStart, int numSamples) const {
+
+    const auto startGain = getPathGain (1, blockStart);
+    const auto endGain = getPathGain (1, blockStart + numSamples);
+
+    for (int ch = 0; ch < graph.channelsPerBuffer; ++ch) {
+        const auto* in = graph.getChannel (step.inputs[0], ch);
+        auto* a = graph.getChannel (step.outputs[0], ch);
+        auto* b = graph.getChannel (step.outputs[1], ch);
+
+        if (startGain == endGain) {
+            writeScaled (a, in, 1.0f - startGain, numSamples);
+            writeScaled (b, in, startGain, numSamples);
+            continue;
+        }
+
+        // Mid-fade, which can start anywhere in the block
+        for (int i = 0; i < numSamples; ++i) {
+            const auto gain = getPathGain (1, blockStart + i);
+            a[i] = in[i] * (1.0f - gain);
+            b[i] = in[i] * gain;
+        }
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::runSchedule (BlockContext& context) {
+
+    auto& graph = *context.graph;
+
+    for (auto& phase : graph.phases) {
+        if (phase.numTasks > 1 && workerPool != nullptr) {
+            context.phase = &phase;
+            workerPool->run (phase.numTasks, runTaskInPool, &context);
+        }
+        else {
+            for (int i = 0; i < phase.numTasks; ++i)
+                runTask (context, graph.tasks[(size_t) (phase.firstTask + i)]);
+        }
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::runTaskInPool (void* context, int taskIndex) {
+
+    auto& block = *static_cast<BlockContext*> (context);
+    block.owner->runTask (block, block.graph->tasks[(size_t) (block.phase->firstTask + taskIndex)]);
+}
+
+// ****************************************************************************
+void SignalGraph::runTask (const BlockContext& context, GraphTask& task) {
+
+    auto& graph = *context.graph;
+    const int numChannels = graph.channelsPerBuffer;
+    const int numSamples = context.numSamples;
+    const int offset = context.offset;
+
+    for (int i = 0; i < task.numSteps; ++i) {
+        auto& step = graph.steps[(size_t) (task.firstStep + i)];
+        const int output = step.pipelined ? step.parityOutputs[(size_t) context.parity] : step.outputs[0];
+
+        // The A/B switch has faded out of this path and its tails are gone.
+        //  A swap into a sleeping slot has nothing to fade, so it just lands,
+        //  and one that was fading when the path went quiet finishes here.
+        if (step.path >= 0 && pathAsleep[(size_t) step.path] && (step.op == StepOp::process || step.op == StepOp::mix)) {
+            if (step.slot != nullptr && step.slot->swapPending) {
+                step.slot->current = step.slot->incoming;
+                step.slot->swapPending = false;
+                step.slot->swapState.store (SlotProcessor::finished, std::memory_order_release);
+            }
+            if (step.slot != nullptr && step.slot->swapState.load (std::memory_order_relaxed) == SlotProcessor::fading) {
+                step.slot->fadingOut = nullptr;
+                step.slot->swapState.store (SlotProcessor::finished, std::memory_order_release);
+            }
+            if (step.slot != nullptr)
+                step.slot->sleptSamples.fetch_add (numSamples, std::memory_order_relaxed);
+            graph.clearBuffer (output, numSamples);
+            meterBuffer (graph, step.node, 0, output, numSamples);
+            continue;
+        }
+
+        switch (step.op) {
+
+            case StepOp::readInput: {
+                auto* left = graph.getChannel (step.outputs[0], 0);
+                if (context.numInputChannels > 0 && context.inputChannelData[0] != nullptr)
+                    juce::FloatVectorOperations::copy (left, context.inputChannelData[0] + offset, numSamples);
+                else
+                    juce::FloatVectorOperations::clear (left, numSamples);
+
+                // Mono guitar feeds both sides of the stereo paths
+                juce::FloatVectorOperations::copy (graph.getChannel (step.outputs[0], 1), left, numSamples);
+                for (int ch = 2; ch < numChannels; ++ch)
+                    juce::FloatVectorOperations::clear (graph.getChannel (step.outputs[0], ch), numSamples);
+                meterBuffer (graph, step.node, 0, step.outputs[0], numSamples);
+            }
+            break;
+
+            case StepOp::abSwitch:
+                switchPaths (graph, step, context.streamStart + offset, numSamples);
+                meterBuffer (graph, step.node, 0, step.outputs[0], numSamples);
+                meterBuffer (graph, step.node, 1, step.outputs[1], numSamples);
+            break;
+
+            case StepOp::process: {
+                const int in  = step.pipelined ? step.parityInputs[(size_t) context.parity]  : step.inputs[0];
+                const auto blockStart = context.streamStart + offset;
+                const auto start = AudioProfiler::now();
+                processSlot (*step.slot, step, graph, in, output, task.scratchBuffer, blockStart, numSamples);
+                const auto end = AudioProfiler::now();
+
+                // A task never runs on two threads at once, so it can own a lane
+                if (context.profiler != nullptr)
+                    context.profiler->record (1 + (int) (&task - graph.tasks.data()), step.node, start, end, numSamples);
+                checkDeadline (*step.slot, end - start, numSamples);
+                meterBuffer (graph, step.node, 0, output, numSamples);
+            }
+            break;
+
+            case StepOp::mix:
+                for (int in = 0; in < step.numInputs; ++in) {
+                    const auto source = step.inputs[(size_t) in];
+                    if (step.inputDelays[(size_t) in] > 0)
+                        graph.delayBuffer (step.firstDelayLine + in, source, step.outputs[0], in > 0, numSamples);
+                    else if (in > 0)
+                        for (int ch = 0; ch < numChannels; ++ch)
+                            juce::FloatVectorOperations::add (graph.getChannel (step.outputs[0], ch),
+                                                              graph.getChannel (source, ch), numSamples);
+                    else if (source != step.outputs[0])
+                        graph.copyBuffer (source, step.outputs[0], numSamples);
+                }
+                meterBuffer (graph, step.node, 0, step.outputs[0], numSamples);
+            break;
+
+            case StepOp::writeOutput:
+                for (int ch = 0; ch < context.numOutputChannels; ++ch) {
+                    if (auto* out = context.outputChannelData[ch]) {
+                        if (ch < 2) {
+                            auto* mix = graph.getChannel (step.inputs[0], ch);
+                            if (mix != out + offset)
+                                juce::FloatVectorOperations::copy (out + offset, mix, numSamples);
+                        }
+                        else
+                            juce::FloatVectorOperations::clear (out + offset, numSamples);
+                    }
+                }
+                meterBuffer (graph, step.node, 0, step.inputs[0], numSamples);
+            break;
+        }
+
+        // Where a path hands its audio on, keep track of how long it's been quiet
+        if (step.pathExit) {
+            const bool quiet = graph.isSilent (output, numSamples, silenceThreshold);
+            step.quietSamples = quiet ? juce::jmin (step.quietSamples + numSamples, 1 << 30) : 0;
+        }
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::meterBuffer (const CompiledGraph& graph, int node, int port, int buffer, int numSamples) {
+
+    // A node belongs to exactly one task, so each tap has a single writer
+    if (auto* tap = meters.getTapForNode (node, port)) {
+        const float* channels[] = { graph.getChannel (buffer, 0), graph.getChannel (buffer, 1) };
+        tap->measure (channels, 2, numSamples);
+    }
+}
+
+// ****************************************************************************
+void SignalGraph::checkDeadline (SlotProcessor& slot, juce::int64 elapsedTicks, int numSamples) {
+
+    const auto budget = watchdogBudget.load (std::memory_order_relaxed);
+    if (budget <= 0.0 || slot.bypassed.load (std::memory_order_relaxed))
+        return;
+
+    if ((double) elapsedTicks <= budget * ticksPerSample * numSamples) {
+        slot.samplesSinceOverrun = juce::jmin (slot.samplesSinceOverrun + numSamples, 1 << 30);
+        if (slot.samplesSinceOverrun >= watchdogForgiveSamples)
+            slot.overruns = 0;
+        return;
+    }
+
+    // One overrun can be a page fault or a preset load, a few close together
+    //  are a plugin that will keep doing it. The bypass ramps like any other.
+    slot.samplesSinceOverrun = 0;
+    if (++slot.overruns < watchdogStrikes)
+        return;
+
+    slot.overruns = 0;
+    slot.bypassed.store (true, std::memory_order_relaxed);
+    slot.watchdogState.store (SlotProcessor::tripped, std::memory_order_release);
+}
+
+// ****************************************************************************
+bool SignalGraph::hasMidiFor (int slotIndex, juce::int64 blockStart, int numSamples) const {
+
+    for (int i = 0; i < numPendingMidi; ++i) {
+        auto& pending = pendingMidi[(size_t) i];
+        if (pending.time >= blockStart && pending.time < blockStart + numSamples
+            && (pending.event.target < 0 || pending.event.target == slotIndex))
+            return true;
+    }
+    return false;
+}
+
+// ****************************************************************************
+void SignalGraph::processSlot (SlotProcessor& slot, const GraphStep& step, CompiledGraph& graph, int input, int output,
+                               int scratch, juce::int64 blockStart, int numSamples) {
+
+    // Pick up a swap at the block boundary
+    if (slot.swapPending) {
+        slot.swapPending = false;
+        slot.overruns = 0;
+        slot.fadingOut = slot.current;
+        slot.current = slot.incoming;
+        slot.fadeLength = juce::jmax (1, crossfadeSamples.load (std::memory_order_relaxed));
+        slot.fadePosition = 0;
+        slot.swapState.store (SlotProcessor::fading, std::memory_order_release);
+    }
+
+    // Each plugin gets this block's share of the incoming MIDI, with sample
+    //  offsets relative to the block. The buffer was sized up front, and a
+    //  plugin may add to it, so it's refilled for every call.
+    auto runPlugin = [&] (juce::AudioPluginInstance* plugin, juce::AudioBuffer<float>& buffer) {
+        if (plugin == nullptr || plugin->isSuspended())
+            return;
+
+        slot.midi.clear();
+        for (int i = 0; i < numPendingMidi; ++i) {
+            auto& pending = pendingMidi[(size_t) i];
+            const auto position = pending.time - blockStart;
+            if (position >= 0 && position < numSamples && (pending.event.target < 0 || pending.event.target == step.slotIndex))
+                slot.midi.addEvent (pending.event.data.data(), pending.event.size, (int) position);
+        }
+        plugin->processBlock (buffer, slot.midi);
+    };
+
+    if (input != output)
+        graph.copyBuffer (input, output, numSamples);
+    auto& out = graph.getView (output, numSamples);
+
+    const bool bypass = slot.bypassed.load (std::memory_order_relaxed);
+
+    // A bypassed slot is a straight wire, so a swap into it completes silently
+    if (slot.wasBypassed && slot.swapState.load (std::memory_order_relaxed) == SlotProcessor::fading) {
+        slot.fadingOut = nullptr;
+        slot.swapState.store (SlotProcessor::finished, std::memory_order_release);
+    }
+
+    if (bypass && slot.wasBypassed)
+        return;
+
+    if (slot.swapState.load (std::memory_order_relaxed) != SlotProcessor::fading) {
+        if (bypass == slot.wasBypassed) {
+            // Silence in and a tail that has run out means silence out, so a
+            //  sleeping plugin isn't called at all. The input is checked every
+            //  block and the first sound, or MIDI for the slot, wakes it.
+            const bool inputSilent = step.sleepAfterSamples >= 0 && graph.isSilent (output, numSamples, silenceThreshold)
+                                      && ! hasMidiFor (step.slotIndex, blockStart, numSamples);
+            if (inputSilent && slot.asleep) {
+                graph.clearBuffer (output, numSamples);
+                slot.sleptSamples.fetch_add (numSamples, std::memory_order_relaxed);
+                return;
+            }
+
+            if (slot.asleep) {
+                slot.asleep = false;
+                slot.wakeups.fetch_add (1, std::memory_order_relaxed);
+            }
+
+            runPlugin (slot.current, out);
+            slot.processedSamples.fetch_add (numSamples, std::memory_order_relaxed);
+
+            const bool outputSilent = inputSilent && graph.isSilent (output, numSamples, silenceThreshold);
+            slot.quietSamples = outputSilent ? juce::jmin (slot.quietSamples + numSamples, 1 << 30) : 0;
+            slot.asleep = outputSilent && slot.quietSamples >= step.sleepAfterSamples;
+            return;
+        }
+
+        // A slot only sleeps while nothing about it is changing
+        slot.asleep = false;
+        slot.quietSamples = 0;
+
+        // Bypass switched: ramp between the plugin and the dry signal over one block
+        graph.copyBuffer (output, scratch, numSamples);
+        auto& dry = graph.getView (scratch, numSamples);
+        runPlugin (slot.current, out);
+
+        const auto wetStart = bypass ? 1.0f : 0.0f;
+        for (int ch = 0; ch < graph.channelsPerBuffer; ++ch) {
+            out.applyGainRamp (ch, 0, numSamples, wetStart, 1.0f - wetStart);
+            out.addFromWithRamp (ch, 0, dry.getReadPointer (ch), numSamples, 1.0f - wetStart, wetStart);
+        }
+        slot.wasBypassed = bypass;
+        return;
+    }
+
+    // Mid-swap: the old plugin runs on a copy of the input and we ramp from
+    //  its output to the new one's. An empty side is a dry passthrough. A
+    //  bypass that comes in now waits for the fade to finish.
+    slot.asleep = false;
+    slot.quietSamples = 0;
+    graph.copyBuffer (input, scratch, numSamples);
+    auto& old = graph.getView (scratch, numSamples);
+    runPlugin (slot.fadingOut, old);
+    runPlugin (slot.current, out);
+
+    const int rampSamples = juce::jmin (numSamples, slot.fadeLength - slot.fadePosition);
+    const auto startGain = (float) slot.fadePosition / (float) slot.fadeLength;
+    const auto endGain = (float) (slot.fadePosition + rampSamples) / (float) slot.fadeLength;
+
+    for (int ch = 0; ch < graph.channelsPerBuffer; ++ch) {
+        out.applyGainRamp (ch, 0, rampSamples, startGain, endGain);
+        out.addFromWithRamp (ch, 0, old.getReadPointer (ch), rampSamples, 1.0f - startGain, 1.0f - endGain);
+    }
+
+    slot.fadePosition += rampSamples;
+    if (slot.fadePosition >= slot.fadeLength) {
+        slot.fadingOut = nullptr;
+        slot.swapState.store (SlotProcessor::finished, std::memory_order_release);
+    }
+}